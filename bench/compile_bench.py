@@ -0,0 +1,83 @@
+"""
+Measures compile time and object size of the reflection layer for generated structs.
+
+usage: compile_bench.py --cxx <compiler> -I <include dir> [--fields 10,50,200] [--flags "-O2"]
+"""
+import os, shutil, subprocess, sys, tempfile, time
+from argparse import ArgumentParser
+
+parser = ArgumentParser()
+parser.add_argument("--cxx", dest="cxx", default=os.environ.get("CXX", "c++"))
+parser.add_argument("-I", dest="inc", action="append", default=[])
+parser.add_argument("--fields", dest="fields", default="10,50,200")
+parser.add_argument("--flags", dest="flags", default="-O2")
+parser.add_argument("--repeat", dest="repeat", type=int, default=3)
+options = parser.parse_args()
+
+types = ["int", "double", "std::string", "long"]
+
+def generate(n):
+    members = "\n".join("    %s f%d;" % (types[i % len(types)], i) for i in range(n))
+    metadata = "\n".join("    CXL_REFLECTED_MEMBER(%d, f%d)" % (i, i) for i in range(n))
+    return r"""#include <string>
+#include <sstream>
+#include <iterator>
+#include <cxl/reflection.hpp>
+#include <cxl/reflection/csv.hpp>
+
+struct wide
+{
+%(members)s
+};
+
+CXL_EXT_BEGIN_REFLECTED(wide, %(n)d)
+%(metadata)s
+CXL_EXT_END_REFLECTED()
+
+struct sink
+{
+    template<typename T>
+    void operator()(const T &t) const { os << t; }
+
+    std::ostream &os;
+};
+
+std::string touch(wide &w, std::size_t n, const std::string &key)
+{
+    std::stringstream ss;
+    cxl::set(n, w, cxl::get_variant(key, w));
+    ss << cxl::get_element_name<wide>(n) << cxl::get_element_sql_field<wide>(n);
+    cxl::for_each_element(w, sink{ss});
+    std::ostream_iterator<char> oi(ss);
+    cxl::reflection::csv::write(w, oi);
+    return ss.str();
+}
+""" % {"members": members, "metadata": metadata, "n": n}
+
+def measure(cxx, src, obj):
+    cmd = [cxx, "-std=c++14"] + options.flags.split() + ["-I" + i for i in options.inc] + ["-c", src, "-o", obj]
+    best = None
+    for _ in range(options.repeat):
+        start = time.time()
+        subprocess.check_call(cmd)
+        elapsed = time.time() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, os.path.getsize(obj), text_size(obj)
+
+def text_size(obj):
+    # Berkeley format of binutils `size`: text data bss dec hex filename
+    if shutil.which("size") is None:
+        return -1
+    out = subprocess.check_output(["size", obj]).decode().splitlines()
+    return int(out[1].split()[0])
+
+print("%8s %12s %14s %12s" % ("fields", "compile(s)", "object(bytes)", "text(bytes)"))
+with tempfile.TemporaryDirectory(prefix="cxl_bench_") as tmp:
+    for n in [int(f) for f in options.fields.split(",")]:
+        src = os.path.join(tmp, "wide_%d.cpp" % n)
+        obj = os.path.join(tmp, "wide_%d.o" % n)
+        with open(src, "w") as f:
+            f.write(generate(n))
+        elapsed, size, text = measure(options.cxx, src, obj)
+        print("%8d %12.2f %14d %12d" % (n, elapsed, size, text))
+        sys.stdout.flush()
@@ -0,0 +1,99 @@
+#ifndef CXL_MAPPED_FILE_HPP
+#define CXL_MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cxl {
+    /**
+     * A whole file mapped read-only into memory, POSIX only. Errors throw std::system_error.
+     */
+    class mapped_file
+    {
+    public:
+        mapped_file() : data_(nullptr), size_(0) { }
+
+        explicit mapped_file(const char *path) : mapped_file()
+        {
+            open(path);
+        }
+
+        explicit mapped_file(const std::string &path) : mapped_file(path.c_str()) { }
+
+        mapped_file(mapped_file &&rhs) : data_(rhs.data_), size_(rhs.size_)
+        {
+            rhs.data_ = nullptr;
+            rhs.size_ = 0;
+        }
+
+        mapped_file &operator=(mapped_file &&rhs)
+        {
+            if (this != &rhs) {
+                close();
+                std::swap(data_, rhs.data_);
+                std::swap(size_, rhs.size_);
+            }
+            return *this;
+        }
+
+        mapped_file(const mapped_file &) = delete;
+
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        ~mapped_file() { close(); }
+
+        void open(const char *path)
+        {
+            close();
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), path);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                int e = errno;
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), path);
+            }
+            // mmap rejects empty mappings, an empty file is just empty
+            if (st.st_size > 0) {
+                void *p = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    int e = errno;
+                    ::close(fd);
+                    throw std::system_error(e, std::generic_category(), path);
+                }
+                ::madvise(p, std::size_t(st.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const char *>(p);
+                size_ = std::size_t(st.st_size);
+            }
+            ::close(fd);
+        }
+
+        void close()
+        {
+            if (data_ != nullptr) {
+                ::munmap(const_cast<char *>(data_), size_);
+            }
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        const char *data() const { return data_; }
+
+        std::size_t size() const { return size_; }
+
+    private:
+        const char *data_;
+        std::size_t size_;
+    };
+} // End of namespace cxl
+
+#endif // CXL_MAPPED_FILE_HPP
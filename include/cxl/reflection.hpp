@@ -1,6 +1,7 @@
 #ifndef CXL_REFLECTION_HPP
 #define CXL_REFLECTION_HPP
 
+#include <cstddef>
 #include <cxl/reflection/reflection_impl.hpp>
 
 #define CXL_PP_CONCAT9(a, b, c, d, e, f, g, h, i) a b c d e f g h i
@@ -74,6 +75,8 @@ public:
         static std::enable_if_t<!std::is_const<decltype(Owner::NAME)>::value, type>&&              \
         get(Owner&& d) { return static_cast<type&&>(d.NAME); }                                     \
         static type const& get(owner_type const& d) { return d.NAME; }                             \
+        template <typename Owner = owner_type>                                                     \
+        static constexpr std::size_t offset() { return offsetof(Owner, NAME); }                    \
         template <typename Owner, typename V>                                                      \
         static std::enable_if_t<!std::is_const<decltype(Owner::NAME)>::value> set(Owner& d, V&& v) \
         { d.NAME = std::forward<V>(v); }                                                           \
@@ -95,6 +98,8 @@ public:
         static std::enable_if_t<!std::is_const<decltype(Owner::NAME)>::value, type>&&              \
         get(Owner&& d) { return static_cast<type&&>(d.NAME); }                                     \
         static type const& get(owner_type const& d) { return d.NAME; }                             \
+        template <typename Owner = owner_type>                                                     \
+        static constexpr std::size_t offset() { return offsetof(Owner, NAME); }                    \
         template <typename Owner, typename V>                                                      \
         static std::enable_if_t<!std::is_const<decltype(Owner::NAME)>::value> set(Owner& d, V&& v) \
         { d.NAME = std::forward<V>(v); }                                                           \
@@ -110,6 +115,8 @@ public:
         static constexpr char const* name() { return #NAME; }                                      \
         static constexpr char const* key() { return #NAME; }                                       \
         static type const& get(owner_type const& d) { return d.NAME; }                             \
+        template <typename Owner = owner_type>                                                     \
+        static constexpr std::size_t offset() { return offsetof(Owner, NAME); }                    \
         CXL_PP_CONCAT(ARGS);                                                                       \
     };
 
@@ -122,6 +129,8 @@ public:
         static constexpr char const* name() { return #NAME; }                                      \
         static constexpr char const* key() { return KEY; }                                         \
         static type const& get(owner_type const& d) { return d.NAME; }                             \
+        template <typename Owner = owner_type>                                                     \
+        static constexpr std::size_t offset() { return offsetof(Owner, NAME); }                    \
         CXL_PP_CONCAT(ARGS);                                                                       \
     };
 
@@ -177,6 +186,10 @@ public:
         CXL_PP_CONCAT(ARGS);                                                                       \
     };
 
+// Typed metadata of the element of TYPE with key() KEY, resolved at compile time,
+// e.g. CXL_FIELD(S, "MM3")::get(s), an unknown key fails to compile
+#define CXL_FIELD(TYPE, KEY) ::cxl::reflection::reflected_element<::cxl::reflection::index_of<TYPE>(KEY), TYPE>
+
 #define CXL_MEM_GETTER(GETTER) d.GETTER()
 #define CXL_MEM_SETTER(SETTER) d.SETTER(std::forward<V>(v))
 
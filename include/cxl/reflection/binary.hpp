@@ -0,0 +1,915 @@
+#ifndef CXL_REFLECTION_BINARY_HPP
+#define CXL_REFLECTION_BINARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/member_runs.hpp>
+#include <cxl/reflection/text_sink.hpp>
+#include <cxl/reflection/value_kind.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace binary {
+            namespace detail {
+                using reflection::detail::string_sink;
+                using reflection::detail::unsupported_kind;
+                using reflection::detail::null_kind;
+                using reflection::detail::bool_kind;
+                using reflection::detail::integer_kind;
+                using reflection::detail::enum_kind;
+                using reflection::detail::float_kind;
+                using reflection::detail::string_kind;
+                using reflection::detail::variant_kind;
+                using reflection::detail::tuple_kind;
+                using reflection::detail::object_kind;
+                using reflection::detail::map_kind;
+                using reflection::detail::range_kind;
+                using reflection::detail::value_kind;
+                using reflection::detail::parsed_type;
+                using reflection::detail::by_value;
+                using reflection::detail::run_start;
+                using reflection::detail::in_run;
+
+                // Raw members and floating point values are copied in host byte order and read back the
+                // same way, so the format is little-endian and needs a little-endian host
+#ifdef __BYTE_ORDER__
+                static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "binary: little-endian hosts only");
+#endif
+
+                constexpr std::uint64_t fnv_basis = 14695981039346656037ULL;
+                constexpr std::uint64_t fnv_prime = 1099511628211ULL;
+
+                // FNV-1a over the 8 bytes of `v`
+                constexpr std::uint64_t mix(std::uint64_t h, std::uint64_t v)
+                {
+                    for (int i = 0; i < 8; i++) {
+                        h = (h ^ ((v >> (8 * i)) & 0xff)) * fnv_prime;
+                    }
+                    return h;
+                }
+
+                constexpr std::uint64_t mix(std::uint64_t h, const char *s)
+                {
+                    std::uint64_t n = 0;
+                    for (; s[n] != '\0'; n++) {
+                        h = (h ^ static_cast<unsigned char>(s[n])) * fnv_prime;
+                    }
+                    return mix(h, n);
+                }
+
+                // A node of the schema: its tag, then its children in order
+                constexpr std::uint64_t node(char tag, std::initializer_list<std::uint64_t> children)
+                {
+                    std::uint64_t h = mix(mix(fnv_basis, std::uint64_t(tag)), children.size());
+                    for (std::uint64_t c : children) {
+                        h = mix(h, c);
+                    }
+                    return h;
+                }
+
+                /*
+                 * Fingerprint of the encoding of T, built at compile time from the shape of the type:
+                 * integer and float widths and signedness, the keys and schemas of reflected elements,
+                 * alternatives, element types of containers. Types encoded alike share a fingerprint.
+                 * The shallow schema (Deep false) stops at reflected objects, which the tagged encoding
+                 * describes field by field.
+                 */
+                template<typename T, bool Deep = true, typename Kind = value_kind<T>>
+                struct schema;
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, null_kind> : std::integral_constant<std::uint64_t, node('n', {})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, bool_kind> : std::integral_constant<std::uint64_t, node('b', {})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, integer_kind>
+                        : std::integral_constant<std::uint64_t,
+                                                 node(std::is_signed<T>::value ? 'i' : 'u', {sizeof(T)})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, enum_kind> : schema<std::underlying_type_t<T>, Deep>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, float_kind>
+                        : std::integral_constant<std::uint64_t, node('f', {sizeof(T)})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, string_kind> : std::integral_constant<std::uint64_t, node('s', {})>
+                {
+                };
+
+                template<bool Deep, typename... U>
+                struct schema<cxl::variant<U...>, Deep, variant_kind>
+                        : std::integral_constant<std::uint64_t,
+                                                 node('v', {schema<uncv<unwrap_type<U>>, Deep>::value...})>
+                {
+                };
+
+                template<std::size_t I, typename T, bool Deep = true>
+                using element_schema = schema<uncv<reflected_element_type<I, T>>, Deep>;
+
+                template<typename T, bool Deep, std::size_t... I>
+                constexpr std::uint64_t elements_schema(std::index_sequence<I...>, tuple_kind)
+                {
+                    return node('t', {element_schema<I, T, Deep>::value...});
+                }
+
+                template<typename T, bool Deep, std::size_t... I>
+                constexpr std::uint64_t elements_schema(std::index_sequence<I...>, object_kind)
+                {
+                    return node('o', {mix(mix(fnv_basis, reflected_element<I, T>::key()),
+                                          element_schema<I, T>::value)...});
+                }
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, tuple_kind>
+                        : std::integral_constant<std::uint64_t, elements_schema<T, Deep>(
+                                std::make_index_sequence<tuple_size<T>::value>(), tuple_kind())>
+                {
+                };
+
+                template<typename T>
+                struct schema<T, true, object_kind>
+                        : std::integral_constant<std::uint64_t, elements_schema<T, true>(
+                                std::make_index_sequence<tuple_size<T>::value>(), object_kind())>
+                {
+                };
+
+                template<typename T>
+                struct schema<T, false, object_kind> : std::integral_constant<std::uint64_t, node('o', {})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, map_kind>
+                        : std::integral_constant<std::uint64_t, node('m', {
+                                schema<uncv<typename T::key_type>, Deep>::value,
+                                schema<uncv<typename T::mapped_type>, Deep>::value})>
+                {
+                };
+
+                template<typename T, bool Deep>
+                struct schema<T, Deep, range_kind>
+                        : std::integral_constant<std::uint64_t,
+                                                 node('r', {schema<typename parsed_type<
+                                                         typename T::value_type>::type, Deep>::value})>
+                {
+                };
+
+                // 32 bits of a 64 bit hash
+                constexpr std::uint32_t fold(std::uint64_t h)
+                {
+                    return std::uint32_t(h ^ (h >> 32));
+                }
+
+                /*
+                 * Tag of the I-th field of T in the tagged encoding, from its key and shallow schema: a
+                 * field whose type changed is another field, a nested object that gained or lost
+                 * fields is not.
+                 */
+                template<std::size_t I, typename T>
+                using field_tag = std::integral_constant<std::uint32_t, fold(mix(
+                        mix(fnv_basis, reflected_element<I, T>::key()), element_schema<I, T, false>::value))>;
+
+                template<typename T, std::size_t... I>
+                struct field_tags
+                {
+                    // One more for types with no fields
+                    static constexpr std::uint32_t value[] = {field_tag<I, T>::value..., 0};
+
+                    static constexpr bool distinct()
+                    {
+                        for (std::size_t i = 0; i < sizeof...(I); i++) {
+                            for (std::size_t j = i + 1; j < sizeof...(I); j++) {
+                                if (value[i] == value[j]) {
+                                    return false;
+                                }
+                            }
+                        }
+                        return true;
+                    }
+                };
+
+                template<typename T, std::size_t... I>
+                constexpr std::uint32_t field_tags<T, I...>::value[];
+
+                // Types stored as their object representation, bool is not as not every byte is a bool
+                template<typename U>
+                using is_raw_type = bool_t<(std::is_arithmetic<U>::value && !std::is_same<U, bool>::value)
+                                           || std::is_enum<U>::value>;
+
+                // Readonly members are not raw, they can't be decoded in place
+                template<typename U>
+                using is_raw_member_type = bool_t<!std::is_const<U>::value && is_raw_type<U>::value>;
+
+                // A member is encoded by value, as the start of a run of adjacent raw members copied as
+                // one block, or not at all because it's in such a run
+                template<std::size_t I, typename T>
+                using member_kind = reflection::detail::raw_member_kind<is_raw_member_type, I, T>;
+
+                template<std::size_t I, typename T>
+                using run_end = reflection::detail::raw_run_end<is_raw_member_type, I, T>;
+
+                // LEB128, for lengths, counts and variant indices
+                template<typename Sink>
+                void write_varint(Sink &sink, std::uint64_t v)
+                {
+                    char buf[10];
+                    std::size_t n = 0;
+                    while (v >= 0x80) {
+                        buf[n++] = char(v | 0x80);
+                        v >>= 7;
+                    }
+                    buf[n++] = char(v);
+                    sink.append(buf, n);
+                }
+
+                template<typename Sink, typename T>
+                void encode_value(Sink &sink, const T &t);
+
+                template<typename Sink>
+                void encode_value(Sink &, std::nullptr_t, null_kind)
+                {
+                }
+
+                template<typename Sink>
+                void encode_value(Sink &sink, bool t, bool_kind)
+                {
+                    sink.put(t ? 1 : 0);
+                }
+
+                // Integers, enums and floating point numbers as in memory, little-endian hosts only
+                template<typename Sink, typename T, typename Kind>
+                std::enable_if_t<Kind::value == integer_kind::value || Kind::value == enum_kind::value
+                                 || Kind::value == float_kind::value>
+                encode_value(Sink &sink, const T &t, Kind)
+                {
+                    sink.append(reinterpret_cast<const char *>(&t), sizeof(T));
+                }
+
+                template<typename Sink, typename Traits, typename Allocator>
+                void encode_value(Sink &sink, const std::basic_string<char, Traits, Allocator> &t,
+                                  string_kind)
+                {
+                    write_varint(sink, t.size());
+                    sink.append(t.data(), t.size());
+                }
+
+                template<typename Sink>
+                struct variant_encoder
+                {
+                    template<typename U>
+                    void operator()(const U &u) const
+                    {
+                        encode_value(sink, u);
+                    }
+
+                    Sink &sink;
+                };
+
+                // The index of the current alternative followed by its value, a variant left empty by a
+                // throwing assignment has no encoding
+                template<typename Sink, typename... U>
+                void encode_value(Sink &sink, const cxl::variant<U...> &t, variant_kind)
+                {
+                    if (t.which() >= sizeof...(U)) {
+                        throw std::invalid_argument("binary: cannot encode an empty variant");
+                    }
+                    write_varint(sink, t.which());
+                    t.apply_visitor(variant_encoder<Sink>{sink});
+                }
+
+                template<std::size_t I, typename Sink, typename T>
+                void encode_element(Sink &sink, const T &t, by_value)
+                {
+                    encode_value(sink, reflected_element<I, T>::get(t));
+                }
+
+                template<std::size_t I, typename Sink, typename T>
+                void encode_element(Sink &sink, const T &t, run_start)
+                {
+                    constexpr std::size_t begin = get_element_offset<I, T>();
+                    sink.append(reinterpret_cast<const char *>(&t) + begin, run_end<I, T>::value - begin);
+                }
+
+                template<std::size_t I, typename Sink, typename T>
+                void encode_element(Sink &, const T &, in_run)
+                {
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void encode_elements(Sink &sink, const T &t, std::index_sequence<I...>)
+                {
+                    typedef int expander[];
+                    (void) expander{0, (encode_element<I>(sink, t, member_kind<I, T>()), 0)...};
+                }
+
+                // Elements in order, nested reflectables inline
+                template<typename Sink, typename T, typename Kind>
+                std::enable_if_t<Kind::value == tuple_kind::value || Kind::value == object_kind::value>
+                encode_value(Sink &sink, const T &t, Kind)
+                {
+                    encode_elements(sink, t, std::make_index_sequence<tuple_size<T>::value>());
+                }
+
+                template<typename Sink, typename T>
+                void encode_value(Sink &sink, const T &t, map_kind)
+                {
+                    write_varint(sink, t.size());
+                    for (const auto &e : t) {
+                        encode_value(sink, e.first);
+                        encode_value(sink, e.second);
+                    }
+                }
+
+                // Vectors of raw values are written with one copy
+                template<typename Sink, typename U, typename Allocator>
+                std::enable_if_t<is_raw_type<U>::value>
+                encode_range(Sink &sink, const std::vector<U, Allocator> &t)
+                {
+                    write_varint(sink, t.size());
+                    sink.append(reinterpret_cast<const char *>(t.data()), t.size() * sizeof(U));
+                }
+
+                template<typename Sink, typename T>
+                void encode_range(Sink &sink, const T &t)
+                {
+                    write_varint(sink, std::uint64_t(std::distance(std::begin(t), std::end(t))));
+                    for (const auto &e : t) {
+                        encode_value(sink, e);
+                    }
+                }
+
+                template<typename Sink, typename T>
+                void encode_value(Sink &sink, const T &t, range_kind)
+                {
+                    encode_range(sink, t);
+                }
+
+                // Sink of the tagged encoding, in which reflected objects are written field by field
+                struct tagged_sink
+                {
+                    void put(char c) { s.push_back(c); }
+
+                    void append(const char *p, std::size_t n) { s.append(p, n); }
+
+                    std::string &s;
+                };
+
+                // The tag and size of the field, patched in once the value is written, then the value
+                template<std::size_t I, typename T>
+                void encode_field(tagged_sink &sink, const T &t)
+                {
+                    std::uint32_t header[2] = {field_tag<I, T>::value, 0};
+                    sink.append(reinterpret_cast<const char *>(header), sizeof(header));
+                    std::size_t begin = sink.s.size();
+                    encode_value(sink, reflected_element<I, T>::get(t));
+                    if (sink.s.size() - begin > UINT32_MAX) {
+                        throw std::invalid_argument("binary: field larger than 4 GiB");
+                    }
+                    header[1] = std::uint32_t(sink.s.size() - begin);
+                    std::memcpy(&sink.s[begin - sizeof(header[1])], &header[1], sizeof(header[1]));
+                }
+
+                template<typename T, std::size_t... I>
+                void encode_fields(tagged_sink &sink, const T &t, std::index_sequence<I...>)
+                {
+                    static_assert(field_tags<T, I...>::distinct(), "Two fields have the same tag");
+                    write_varint(sink, sizeof...(I));
+                    typedef int expander[];
+                    (void) expander{0, (encode_field<I>(sink, t), 0)...};
+                }
+
+                // The number of fields, then each field, readonly ones included
+                template<typename T>
+                void encode_value(tagged_sink &sink, const T &t, object_kind)
+                {
+                    encode_fields(sink, t, std::make_index_sequence<tuple_size<T>::value>());
+                }
+
+                template<typename Sink, typename T>
+                void encode_value(Sink &sink, const T &t)
+                {
+                    static_assert(value_kind<uncv<T>>::value != unsupported_kind::value
+                                  && !std::is_pointer<T>::value, "Type cannot be encoded");
+                    encode_value(sink, t, value_kind<uncv<T>>());
+                }
+
+                /*
+                 * How reflected objects are encoded: their elements in order, or tagged fields, written
+                 * by a build with the same fingerprint (read in order) or not (matched by tag)
+                 */
+                enum class format
+                {
+                    compact, exact, tagged
+                };
+
+                /**
+                 * Reads encoded values from memory into their targets. Truncated input and values
+                 * that are out of range throw std::invalid_argument.
+                 */
+                class decoder
+                {
+                public:
+                    decoder(const char *begin, const char *end, format f = format::compact)
+                            : begin_(begin), p_(begin), end_(end), format_(f)
+                    {
+                    }
+
+                    template<typename T>
+                    void decode(T &t)
+                    {
+                        static_assert(value_kind<T>::value != unsupported_kind::value
+                                      && !std::is_pointer<T>::value, "Type cannot be decoded");
+                        decode_value(t, value_kind<T>());
+                    }
+
+                    void raw(void *p, std::size_t n)
+                    {
+                        if (std::size_t(end_ - p_) < n) {
+                            fail("truncated input");
+                        }
+                        // Empty vectors may have a null data()
+                        if (n > 0) {
+                            std::memcpy(p, p_, n);
+                        }
+                        p_ += n;
+                    }
+
+                    std::uint64_t varint()
+                    {
+                        std::uint64_t v = 0;
+                        for (int shift = 0; shift < 64; shift += 7) {
+                            if (p_ == end_) {
+                                fail("truncated input");
+                            }
+                            std::uint64_t b = static_cast<unsigned char>(*p_++);
+                            v |= (b & 0x7f) << shift;
+                            if (b < 0x80) {
+                                return v;
+                            }
+                        }
+                        fail("invalid varint");
+                    }
+
+                    void set_format(format f)
+                    {
+                        format_ = f;
+                    }
+
+                    // A count of items of at least `size` bytes each
+                    std::size_t count(std::size_t size)
+                    {
+                        std::uint64_t n = varint();
+                        if (size > 0 && n > std::uint64_t(end_ - p_) / size) {
+                            fail("truncated input");
+                        }
+                        return std::size_t(n);
+                    }
+
+                    void finish()
+                    {
+                        if (p_ != end_) {
+                            fail("unexpected bytes after the value");
+                        }
+                    }
+
+                    [[noreturn]] void fail(const char *what) const
+                    {
+                        throw std::invalid_argument(std::string("binary: ") + what + " at offset "
+                                                    + std::to_string(p_ - begin_));
+                    }
+
+                private:
+                    void decode_value(std::nullptr_t &, null_kind)
+                    {
+                    }
+
+                    void decode_value(bool &t, bool_kind)
+                    {
+                        unsigned char b;
+                        raw(&b, 1);
+                        if (b > 1) {
+                            fail("invalid bool");
+                        }
+                        t = b != 0;
+                    }
+
+                    template<typename T, typename Kind>
+                    std::enable_if_t<Kind::value == integer_kind::value || Kind::value == enum_kind::value
+                                     || Kind::value == float_kind::value>
+                    decode_value(T &t, Kind)
+                    {
+                        raw(&t, sizeof(T));
+                    }
+
+                    template<typename T>
+                    void decode_value(T &t, string_kind)
+                    {
+                        std::size_t n = count(1);
+                        t.assign(p_, n);
+                        p_ += n;
+                    }
+
+                    template<typename U, typename V>
+                    void decode_alternative(V &v)
+                    {
+                        unwrap_type<U> a{};
+                        decode(a);
+                        v = std::move(a);
+                    }
+
+                    template<typename... U>
+                    void decode_value(cxl::variant<U...> &t, variant_kind)
+                    {
+                        std::uint64_t which = varint();
+                        if (which >= sizeof...(U)) {
+                            fail("invalid variant index");
+                        }
+                        std::uint64_t i = 0;
+                        typedef int expander[];
+                        (void) expander{0, ((i++ == which ? decode_alternative<U>(t) : void()), 0)...};
+                    }
+
+                    // Readonly elements are part of the encoding, they are read and dropped
+                    template<std::size_t I, typename T>
+                    void decode_element(T &t, by_value)
+                    {
+                        typedef reflected_element<I, T> element;
+                        decode_element<I>(t, bool_t<element::use_value
+                                                    || std::is_const<reflected_element_type<I, T>>::value>());
+                    }
+
+                    template<std::size_t I, typename T>
+                    void decode_element(T &t, bool_t<false>)
+                    {
+                        decode(reflected_element<I, T>::get(t));
+                    }
+
+                    template<std::size_t I, typename T>
+                    void decode_element(T &t, bool_t<true>)
+                    {
+                        std::remove_cv_t<reflected_element_type<I, T>> v{};
+                        decode(v);
+                        set_element<I>(t, std::move(v),
+                                       bool_t<std::is_const<reflected_element_type<I, T>>::value>());
+                    }
+
+                    template<std::size_t I, typename T, typename V>
+                    void set_element(T &t, V &&v, bool_t<false>)
+                    {
+                        reflected_element<I, T>::set(t, std::forward<V>(v));
+                    }
+
+                    template<std::size_t I, typename T, typename V>
+                    void set_element(T &, V &&, bool_t<true>)
+                    {
+                    }
+
+                    template<std::size_t I, typename T>
+                    void decode_element(T &t, run_start)
+                    {
+                        constexpr std::size_t begin = get_element_offset<I, T>();
+                        raw(reinterpret_cast<char *>(&t) + begin, run_end<I, T>::value - begin);
+                    }
+
+                    template<std::size_t I, typename T>
+                    void decode_element(T &, in_run)
+                    {
+                    }
+
+                    template<typename T, std::size_t... I>
+                    void decode_elements(T &t, std::index_sequence<I...>)
+                    {
+                        typedef int expander[];
+                        (void) expander{0, (decode_element<I>(t, member_kind<I, T>()), 0)...};
+                    }
+
+                    template<typename T>
+                    void decode_value(T &t, tuple_kind)
+                    {
+                        decode_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+                    }
+
+                    template<typename T>
+                    void decode_value(T &t, object_kind)
+                    {
+                        typedef std::make_index_sequence<tuple_size<T>::value> fields;
+                        if (format_ == format::compact) {
+                            decode_elements(t, fields());
+                        } else if (format_ == format::exact) {
+                            decode_fields(t, fields());
+                        } else {
+                            match_fields(t, fields());
+                        }
+                    }
+
+                    // The tag of the next field, its size is checked against the input left
+                    std::uint32_t field_header(std::size_t &size)
+                    {
+                        std::uint32_t header[2];
+                        raw(header, sizeof(header));
+                        if (header[1] > std::size_t(end_ - p_)) {
+                            fail("truncated input");
+                        }
+                        size = header[1];
+                        return header[0];
+                    }
+
+                    // The value of a field must take up exactly its size
+                    template<std::size_t I, typename T>
+                    void decode_field(T &t, std::size_t size)
+                    {
+                        const char *end = end_;
+                        end_ = p_ + size;
+                        decode_element<I>(t, by_value());
+                        if (p_ != end_) {
+                            fail("field size mismatch");
+                        }
+                        end_ = end;
+                    }
+
+                    template<std::size_t I, typename T>
+                    void decode_field(T &t)
+                    {
+                        std::size_t size;
+                        if (field_header(size) != field_tag<I, T>::value) {
+                            fail("unexpected field");
+                        }
+                        decode_field<I>(t, size);
+                    }
+
+                    // Same fingerprint: every field is there, in order
+                    template<typename T, std::size_t... I>
+                    void decode_fields(T &t, std::index_sequence<I...>)
+                    {
+                        if (varint() != sizeof...(I)) {
+                            fail("unexpected number of fields");
+                        }
+                        typedef int expander[];
+                        (void) expander{0, (decode_field<I>(t), 0)...};
+                    }
+
+                    template<std::size_t I, typename T>
+                    void reset_field(T &t)
+                    {
+                        set_element<I>(t, std::remove_cv_t<reflected_element_type<I, T>>{},
+                                       bool_t<std::is_const<reflected_element_type<I, T>>::value>());
+                    }
+
+                    /*
+                     * Another schema: fields are matched by tag, trying the one after the previous
+                     * match first. Unknown fields are skipped by their size, missing ones are reset to
+                     * a value-initialized one.
+                     */
+                    template<typename T, std::size_t... I>
+                    void match_fields(T &t, std::index_sequence<I...>)
+                    {
+                        typedef field_tags<T, I...> tags;
+                        typedef void (decoder::*field_decoder)(T &, std::size_t);
+                        typedef void (decoder::*field_reset)(T &);
+                        static constexpr field_decoder decoders[] = {&decoder::decode_field<I, T>...,
+                                                                     nullptr};
+                        static constexpr field_reset resets[] = {&decoder::reset_field<I, T>..., nullptr};
+                        bool seen[sizeof...(I) + 1] = {};
+                        std::size_t next = 0;
+                        for (std::size_t n = count(8); n > 0; n--) {
+                            std::size_t size;
+                            std::uint32_t tag = field_header(size);
+                            std::size_t i = next;
+                            if (i == sizeof...(I) || tags::value[i] != tag) {
+                                for (i = 0; i < sizeof...(I) && tags::value[i] != tag; i++) {
+                                }
+                            }
+                            if (i == sizeof...(I)) {
+                                p_ += size;
+                                continue;
+                            }
+                            if (seen[i]) {
+                                fail("duplicate field");
+                            }
+                            (this->*decoders[i])(t, size);
+                            seen[i] = true;
+                            next = i + 1;
+                        }
+                        for (std::size_t i = 0; i < sizeof...(I); i++) {
+                            if (!seen[i]) {
+                                (this->*resets[i])(t);
+                            }
+                        }
+                    }
+
+                    template<typename T>
+                    void decode_value(T &t, map_kind)
+                    {
+                        t.clear();
+                        for (std::size_t n = varint(); n > 0; n--) {
+                            typename T::key_type key{};
+                            decode(key);
+                            typename T::mapped_type value{};
+                            decode(value);
+                            t.emplace(std::move(key), std::move(value));
+                        }
+                    }
+
+                    template<typename U, typename Allocator>
+                    std::enable_if_t<is_raw_type<U>::value> decode_range(std::vector<U, Allocator> &t)
+                    {
+                        t.resize(count(sizeof(U)));
+                        raw(t.data(), t.size() * sizeof(U));
+                    }
+
+                    template<typename T>
+                    void decode_range(T &t)
+                    {
+                        t.clear();
+                        for (std::size_t n = varint(); n > 0; n--) {
+                            typename parsed_type<typename T::value_type>::type value{};
+                            decode(value);
+                            t.insert(t.end(), std::move(value));
+                        }
+                    }
+
+                    template<typename T>
+                    void decode_value(T &t, range_kind)
+                    {
+                        decode_range(t);
+                    }
+
+                    const char *begin_;
+                    const char *p_;
+                    const char *end_;
+                    format format_;
+                };
+            }   // End of namespace detail
+
+            // Fingerprint of the encoding of T, written before every encoded value
+            template<typename T>
+            constexpr std::uint64_t fingerprint()
+            {
+                return detail::schema<uncv<T>>::value;
+            }
+
+            /**
+             * Appends the binary encoding of `t` to `out`: the 8 bytes of fingerprint<T>(), then the
+             * elements in order. Runs of adjacent plain arithmetic and enum members with no padding in
+             * between are copied as one block, integers and floating point numbers are stored as in
+             * memory, lengths and counts as varints, nested reflectables inline. Only little-endian
+             * hosts are supported. An empty variant throws std::invalid_argument.
+             */
+            template<typename T>
+            void encode(std::string &out, const T &t)
+            {
+                detail::string_sink sink{out};
+                std::uint64_t h = fingerprint<T>();
+                sink.append(reinterpret_cast<const char *>(&h), sizeof(h));
+                detail::encode_value(sink, t);
+            }
+
+            template<typename T>
+            std::string encode(const T &t)
+            {
+                std::string ret;
+                encode(ret, t);
+                return ret;
+            }
+
+            /**
+             * Decodes what encode() wrote into `t`, containers are replaced. A fingerprint other than
+             * fingerprint<T>(), truncated input or trailing bytes throw std::invalid_argument.
+             */
+            template<typename T>
+            void decode(const char *data, std::size_t size, T &t)
+            {
+                detail::decoder in(data, data + size);
+                std::uint64_t h;
+                in.raw(&h, sizeof(h));
+                if (h != fingerprint<T>()) {
+                    throw std::invalid_argument("binary: schema mismatch");
+                }
+                in.decode(t);
+                in.finish();
+            }
+
+            template<typename T>
+            void decode(const std::string &data, T &t)
+            {
+                decode(data.data(), data.size(), t);
+            }
+
+            template<typename T>
+            T decode(const char *data, std::size_t size)
+            {
+                T t{};
+                decode(data, size, t);
+                return t;
+            }
+
+            template<typename T>
+            T decode(const std::string &data)
+            {
+                return decode<T>(data.data(), data.size());
+            }
+
+            /**
+             * Appends the tagged encoding of `t` to `out`, which builds with another version of T can
+             * read. It starts with a hash of fingerprint<T>() and a 32 bit tag of the shallow schema of
+             * T, then every field of a reflected object is written as a 32 bit tag made of its key and
+             * type, its size in 32 bits, and its value. Anything else is encoded as by encode().
+             */
+            template<typename T>
+            void encode_tagged(std::string &out, const T &t)
+            {
+                detail::tagged_sink sink{out};
+                std::uint64_t h = detail::mix(fingerprint<T>(), std::uint64_t('T'));
+                std::uint32_t shallow = detail::fold(detail::schema<uncv<T>, false>::value);
+                sink.append(reinterpret_cast<const char *>(&h), sizeof(h));
+                sink.append(reinterpret_cast<const char *>(&shallow), sizeof(shallow));
+                detail::encode_value(sink, t);
+            }
+
+            template<typename T>
+            std::string encode_tagged(const T &t)
+            {
+                std::string ret;
+                encode_tagged(ret, t);
+                return ret;
+            }
+
+            /**
+             * Decodes what encode_tagged() wrote into `t`, from this version of T or another one. When
+             * the fingerprints match the fields are read in order. Otherwise they are matched by tag:
+             * fields T doesn't have, or has with another type, are skipped, and the fields T has that
+             * aren't in the data are value-initialized. Nested objects are matched the same way. A
+             * top-level value of another shape (e.g. a vector for an object), truncated input or
+             * trailing bytes throw std::invalid_argument.
+             *
+             * The data carries no type identity, since versions of a type may differ in name as well
+             * as in fields. Every reflected object has the same shape, so decoding the data of an
+             * unrelated reflected type succeeds like decoding another version of T: only the fields
+             * that happen to share a key and type are kept.
+             */
+            template<typename T>
+            void decode_tagged(const char *data, std::size_t size, T &t)
+            {
+                detail::decoder in(data, data + size);
+                std::uint64_t h;
+                std::uint32_t shallow;
+                in.raw(&h, sizeof(h));
+                in.raw(&shallow, sizeof(shallow));
+                if (shallow != detail::fold(detail::schema<uncv<T>, false>::value)) {
+                    throw std::invalid_argument("binary: schema mismatch");
+                }
+                bool exact = h == detail::mix(fingerprint<T>(), std::uint64_t('T'));
+                in.set_format(exact ? detail::format::exact : detail::format::tagged);
+                in.decode(t);
+                in.finish();
+            }
+
+            template<typename T>
+            void decode_tagged(const std::string &data, T &t)
+            {
+                decode_tagged(data.data(), data.size(), t);
+            }
+
+            template<typename T>
+            T decode_tagged(const char *data, std::size_t size)
+            {
+                T t{};
+                decode_tagged(data, size, t);
+                return t;
+            }
+
+            template<typename T>
+            T decode_tagged(const std::string &data)
+            {
+                return decode_tagged<T>(data.data(), data.size());
+            }
+        }
+    }
+    namespace binary = reflection::binary;
+}
+
+#endif // CXL_REFLECTION_BINARY_HPP
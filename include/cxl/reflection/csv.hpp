@@ -2,15 +2,38 @@
 #define CXL_REFLECTION_CSV_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <streambuf>
+#include <stdexcept>
 #include <type_traits>
 #include <string>
+#include <vector>
 #include <cxl/variant.hpp>
 #include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/row_binder.hpp>
+#include <cxl/reflection/text_input.hpp>
+#include <cxl/reflection/text_sink.hpp>
 
 namespace cxl {
     namespace reflection {
         namespace csv {
             namespace detail {
+                using reflection::detail::needs_escape;
+                using reflection::detail::find_escape;
+                using reflection::detail::iterator_sink;
+                using reflection::detail::string_sink;
+                using reflection::detail::buffer_sink;
+                using reflection::detail::format_unsigned;
+                using reflection::detail::format_integer;
+                using reflection::detail::scan_result;
+                using reflection::detail::input;
+
                 inline char to_hex(char x)
                 {
                     unsigned char c = static_cast<unsigned char>(x);
@@ -24,7 +47,7 @@ namespace cxl {
                 template<typename OutputIterator>
                 std::size_t escape(char c, OutputIterator &&i)
                 {
-                    if (c == '"' || c == '\t' || c == '\r' || c == '\n') {
+                    if (c == '"' || c == '\\' || c == '\t' || c == '\r' || c == '\n') {
                         (*i++) = '\\';
                         (*i++) = c;
                         return 2;
@@ -40,91 +63,156 @@ namespace cxl {
                     }
                 }
 
-                template<typename Traits=std::char_traits<char>,
-                         typename Allocator = std::allocator<char>,
-                         typename OutputIterator>
-                std::size_t write_impl(const std::basic_string<char, Traits, Allocator> &s, OutputIterator &i)
+                // Quotes and escapes [s, s + n), runs of plain chars are appended as a whole
+                template<typename Sink>
+                void write_quoted(Sink &sink, const char *s, std::size_t n)
                 {
-                    std::size_t ret = 2;
-                    (*i++) = '"';
-                    for (char c: s) {
-                        ret += escape(c, std::forward<OutputIterator>(i));
+                    sink.put('"');
+                    const char *end = s + n;
+                    while (s != end) {
+                        const char *run = s;
+                        s = find_escape(s, end);
+                        sink.append(run, std::size_t(s - run));
+                        if (s != end) {
+                            char esc[4];
+                            sink.append(esc, escape(*s++, esc + 0));
+                        }
                     }
-                    (*i++) = '"';
-                    return ret;
+                    sink.put('"');
                 }
 
-                template<typename OutputIterator>
-                std::size_t write_impl(const char *str, OutputIterator &&i)
+                template<typename Sink, typename Traits, typename Allocator>
+                void write_value(Sink &sink, const std::basic_string<char, Traits, Allocator> &s)
                 {
-                    std::size_t ret = 2;
-                    (*i++) = '"';
-                    while (char c = (*str++)) {
-                        ret += escape(c, std::forward<OutputIterator>(i));
-                    }
-                    (*i++) = '"';
-                    return ret;
+                    write_quoted(sink, s.data(), s.size());
                 }
 
-                // TODO: Optimization
-                template<typename T, typename OutputIterator>
-                std::enable_if_t<std::is_integral<T>::value || std::is_floating_point<T>::value, std::size_t>
-                write_impl(T t, OutputIterator &&i)
+                template<typename Sink>
+                void write_value(Sink &sink, const char *s)
                 {
-                    std::string s = std::to_string(t);
-                    for (char c: s) {
-                        (*i++) = c;
-                    }
-                    return s.size();
+                    write_quoted(sink, s, std::strlen(s));
                 }
 
-                template<typename OutputIterator>
-                struct write_visitor
+                // Same output as std::to_string
+                template<typename Sink, typename T>
+                std::enable_if_t<std::is_integral<T>::value> write_value(Sink &sink, T t)
                 {
-                    write_visitor(OutputIterator &&i) : oi(i) { }
+                    char buf[24];
+                    char *p = format_integer(t, buf + sizeof(buf));
+                    sink.append(p, std::size_t(buf + sizeof(buf) - p));
+                }
 
-                    template<typename U>
-                    std::size_t operator()(const U &t) const
-                    {
-                        return write_impl(t, oi);
+                inline int format_float(char *buf, std::size_t size, double t)
+                {
+                    return std::snprintf(buf, size, "%f", t);
+                }
+
+                inline int format_float(char *buf, std::size_t size, long double t)
+                {
+                    return std::snprintf(buf, size, "%Lf", t);
+                }
+
+#ifdef __SIZEOF_INT128__
+                // "%f" of a finite double with |t| < 2^43 without printf: t * 10^6 is computed exactly
+                // as m * 10^6 / 2^k and rounded half to even like glibc, writes backwards from `end`
+                inline char *format_fixed6(double t, char *end)
+                {
+                    int x;
+                    double f = std::frexp(std::fabs(t), &x);
+                    typedef unsigned __int128 wide;
+                    wide m = static_cast<unsigned long long>(std::ldexp(f, 53));
+                    int k = 53 - x;
+                    std::uint64_t q;
+                    if (k <= 0) {
+                        q = std::uint64_t((m << -k) * 1000000u);
+                    } else if (k >= 128) {
+                        q = 0;
+                    } else {
+                        wide v = m * 1000000u;
+                        wide r = v & ((wide(1) << k) - 1);
+                        wide half = wide(1) << (k - 1);
+                        q = std::uint64_t(v >> k);
+                        if (r > half || (r == half && (q & 1) != 0)) {
+                            q++;
+                        }
+                    }
+                    std::uint64_t frac = q % 1000000;
+                    for (int i = 0; i < 6; i++, frac /= 10) {
+                        *--end = char('0' + frac % 10);
                     }
+                    *--end = '.';
+                    end = format_unsigned(q / 1000000, end);
+                    if (std::signbit(t)) {
+                        *--end = '-';
+                    }
+                    return end;
+                }
+#endif
 
-                    OutputIterator &oi;
-                };
+                // Same output as std::to_string, i.e. "%f"
+                template<typename Sink, typename T>
+                std::enable_if_t<std::is_floating_point<T>::value> write_value(Sink &sink, T t)
+                {
+                    typedef std::conditional_t<std::is_same<T, long double>::value, long double, double> F;
+                    char buf[64];
+#ifdef __SIZEOF_INT128__
+                    if (!std::is_same<T, long double>::value && std::fabs(t) < 8796093022208.0) {
+                        char *begin = format_fixed6(double(t), buf + sizeof(buf));
+                        sink.append(begin, std::size_t(buf + sizeof(buf) - begin));
+                        return;
+                    }
+#endif
+                    int n = format_float(buf, sizeof(buf), F(t));
+                    if (n < int(sizeof(buf))) {
+                        sink.append(buf, std::size_t(n));
+                        return;
+                    }
+                    std::vector<char> big(std::size_t(n) + 1);
+                    format_float(big.data(), big.size(), F(t));
+                    sink.append(big.data(), std::size_t(n));
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void write_row(Sink &sink, const T &t, std::index_sequence<I...>)
+                {
+                    typedef int expander[];
+                    (void) expander{0, ((I > 0 ? sink.put(',') : void()),
+                                        write_value(sink, reflected_element<I, T>::get(t)), 0)...};
+                    sink.put('\n');
+                }
 
-                template<typename ...T, typename OutputIterator>
-                std::size_t write_impl(const variant<T...> &t, OutputIterator &&i)
+                template<typename Sink, typename T, std::size_t... I>
+                void write_header_row(Sink &sink, std::index_sequence<I...>)
                 {
-                    return t.apply_visitor(write_visitor<OutputIterator>(std::forward<OutputIterator>(i)));
+                    typedef int expander[];
+                    (void) expander{0, ((I > 0 ? sink.put(',') : void()),
+                                        write_value(sink, get_element_csv_field<T>(I)), 0)...};
+                    sink.put('\n');
                 }
             }   // End of namespace detail
 
             template<typename T, typename OutputIterator>
             std::enable_if_t<cxl::reflectable<T>, std::size_t> write(const T &t, OutputIterator &&i)
             {
-                std::size_t ret = cxl::tuple_size<T>::value;    // N-1 commas and 1 '\n'
-                for (std::size_t n = 0; n < cxl::tuple_size<T>::value; n++) {
-                    if (n > 0) (*i++) = ',';
-                    ret += detail::write_impl(cxl::get_variant<T>(n, t), std::forward<OutputIterator>(i));
-                }
-                (*i++) = '\n';
-                return ret;
+                detail::iterator_sink<std::remove_reference_t<OutputIterator>> sink{i, 0};
+                detail::write_row(sink, t, std::make_index_sequence<cxl::tuple_size<T>::value>());
+                return sink.count;
             }
 
             template<typename T, typename OutputIterator>
             std::enable_if_t<cxl::reflectable<T>, std::size_t> write_header(OutputIterator &&i)
             {
-                std::size_t ret = cxl::tuple_size<T>::value;    // N-1 commas and 1 '\n'
-                for (std::size_t n = 0; n < cxl::tuple_size<T>::value; n++) {
-                    if (n > 0) (*i++) = ',';
-                    ret += detail::write_impl(cxl::get_element_csv_field<T>(n), std::forward<OutputIterator>(i));
-                }
-                (*i++) = '\n';
-                return ret;
+                detail::iterator_sink<std::remove_reference_t<OutputIterator>> sink{i, 0};
+                typedef std::make_index_sequence<cxl::tuple_size<T>::value> indices;
+                detail::write_header_row<decltype(sink), T>(sink, indices());
+                return sink.count;
             }
 
             template<typename InputIterator, typename OutputIterator>
-            std::size_t write_csv(InputIterator begin, InputIterator end, OutputIterator &&oi, bool with_header = true)
+            std::size_t write_csv(InputIterator begin,
+                                  InputIterator end,
+                                  OutputIterator &&oi,
+                                  bool with_header = true)
             {
                 using value_type=typename std::iterator_traits<InputIterator>::value_type;
                 static_assert(cxl::reflectable<value_type>, "Value type must be reflectable");
@@ -137,6 +225,484 @@ namespace cxl {
                 }
                 return ret;
             }
+
+            /**
+             * Buffered CSV writer, same output as `write`/`write_header`. Each row is formatted
+             * member by member into a contiguous buffer, which is handed to the streambuf in whole
+             * blocks when it fills up, on `flush()` and on destruction.
+             */
+            template<typename T>
+            class writer
+            {
+                static_assert(cxl::reflectable<T>, "Value type must be reflectable");
+
+            public:
+                static constexpr std::size_t default_buffer_size = 1 << 16;
+
+                // Uses the caller-provided buffer, which must outlive the writer
+                writer(std::streambuf &sb, char *buffer, std::size_t size)
+                        : sink_(sb, buffer, size)
+                {
+                }
+
+                explicit writer(std::streambuf &sb)
+                        : own_(new char[default_buffer_size]), sink_(sb, own_.get(), default_buffer_size)
+                {
+                }
+
+                writer(const writer &) = delete;
+
+                writer &operator=(const writer &) = delete;
+
+                ~writer()
+                {
+                    try {
+                        sink_.flush();
+                    } catch (...) {
+                    }
+                }
+
+                void write_header()
+                {
+                    detail::write_header_row<detail::buffer_sink, T>(
+                            sink_, std::make_index_sequence<cxl::tuple_size<T>::value>());
+                }
+
+                void write(const T &t)
+                {
+                    detail::write_row(sink_, t, std::make_index_sequence<cxl::tuple_size<T>::value>());
+                }
+
+                template<typename InputIterator>
+                void write(InputIterator begin, InputIterator end)
+                {
+                    for (; begin != end; ++begin) {
+                        write(*begin);
+                    }
+                }
+
+                void flush() { sink_.flush(); }
+
+                // Bytes written so far, including the ones still in the buffer
+                std::size_t size() const { return sink_.size(); }
+
+            private:
+                std::unique_ptr<char[]> own_;
+                detail::buffer_sink sink_;
+            };
+
+            template<typename T>
+            constexpr std::size_t writer<T>::default_buffer_size;
+
+            namespace detail {
+                // A field of a record, pointing into the input
+                struct field
+                {
+                    const char *data;
+                    std::size_t size;
+                    bool escaped;       // Quoted with backslash escapes inside, needs unescape()
+                    bool last;          // Last field of its record
+                };
+
+                inline int from_hex(char c)
+                {
+                    if (c >= '0' && c <= '9') return c - '0';
+                    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+                    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+                    return -1;
+                }
+
+                // Inverse of escape(): '\' followed by '"', '\', TAB, CR or LF is that char, "\xHH" is
+                // a byte, any other backslash is kept as is
+                inline void unescape(const char *p, std::size_t n, std::string &out)
+                {
+                    out.clear();
+                    const char *end = p + n;
+                    while (p != end) {
+                        const char *run = p;
+                        while (p != end && *p != '\\') {
+                            ++p;
+                        }
+                        out.append(run, p);
+                        if (p == end) {
+                            break;
+                        }
+                        char c = end - p >= 2 ? p[1] : '\0';
+                        if (c == '"' || c == '\\' || c == '\t' || c == '\r' || c == '\n') {
+                            out.push_back(c);
+                            p += 2;
+                        } else if (c == 'x' && end - p >= 4 && from_hex(p[2]) >= 0 && from_hex(p[3]) >= 0) {
+                            out.push_back(char(from_hex(p[2]) * 16 + from_hex(p[3])));
+                            p += 4;
+                        } else {
+                            out.push_back(*p++);
+                        }
+                    }
+                }
+
+                // Scans one field at `p`, on success `p` is moved past its terminator. need_more means
+                // the field may continue past `end`, which is only possible if `eof` is false.
+                inline scan_result scan_field(const char *&p, const char *end, bool eof, field &f)
+                {
+                    const char *q = p;
+                    f.escaped = false;
+                    if (q != end && *q == '"') {
+                        f.data = ++q;
+                        for (;;) {
+                            while (q != end && *q != '"' && *q != '\\') {
+                                ++q;
+                            }
+                            if (q == end || (*q == '\\' && end - q < 4)) {
+                                if (!eof) {
+                                    return scan_result::need_more;
+                                }
+                                if (q == end) {
+                                    throw std::invalid_argument("csv: unterminated quoted field");
+                                }
+                            }
+                            if (*q == '"') {
+                                break;
+                            }
+                            f.escaped = true;
+                            q += q + 1 != end ? 2 : 1;
+                        }
+                        f.size = std::size_t(q++ - f.data);
+                        if (q != end && *q == '\r') {
+                            ++q;
+                        }
+                        if (q == end && !eof) {
+                            return scan_result::need_more;
+                        }
+                        if (q != end && *q != ',' && *q != '\n') {
+                            throw std::invalid_argument("csv: unexpected character after quoted field");
+                        }
+                    } else {
+                        f.data = q;
+                        while (q != end && *q != ',' && *q != '\n') {
+                            ++q;
+                        }
+                        if (q == end && !eof) {
+                            return scan_result::need_more;
+                        }
+                        f.size = std::size_t(q - f.data);
+                        if (f.size > 0 && f.data[f.size - 1] == '\r') {
+                            f.size--;
+                        }
+                    }
+                    f.last = q == end || *q == '\n';
+                    p = q == end ? q : q + 1;
+                    return scan_result::ok;
+                }
+
+                // Skips empty lines, end_of_input if nothing is left
+                inline scan_result skip_blank(const char *&p, const char *end, bool eof)
+                {
+                    while (p != end && (*p == '\n' || *p == '\r')) {
+                        ++p;
+                    }
+                    if (p != end) {
+                        return scan_result::ok;
+                    }
+                    return eof ? scan_result::end_of_input : scan_result::need_more;
+                }
+
+                // Moves `p` past the rest of the record without parsing its fields. A record with no
+                // quote left ends at the next LF, otherwise its fields are scanned as by scan_field,
+                // so that an LF in a quoted field doesn't end it.
+                inline scan_result skip_record(const char *&p, const char *end, bool eof)
+                {
+                    const void *found = std::memchr(p, '\n', std::size_t(end - p));
+                    const char *lf = static_cast<const char *>(found);
+                    const char *stop = lf != nullptr ? lf : end;
+                    if (std::memchr(p, '"', std::size_t(stop - p)) == nullptr) {
+                        if (lf == nullptr && !eof) {
+                            return scan_result::need_more;
+                        }
+                        p = lf != nullptr ? lf + 1 : end;
+                        return scan_result::ok;
+                    }
+                    const char *q = p;
+                    field f;
+                    do {
+                        scan_result r = scan_field(q, end, eof, f);
+                        if (r != scan_result::ok) {
+                            return r;
+                        }
+                    } while (!f.last);
+                    p = q;
+                    return scan_result::ok;
+                }
+
+                // Element whose key, or else csv_field, is `name`; tuple_size if there is none
+                template<typename T>
+                std::size_t find_field(const std::string &name)
+                {
+                    const element_descriptor *d = get_element_descriptors<T>();
+                    std::size_t n = reflection::detail::find_key<T>(name.c_str());
+                    if (n == cxl::tuple_size<T>::value) {
+                        n = 0;
+                        while (n < cxl::tuple_size<T>::value && name != d[n].csv_field) {
+                            n++;
+                        }
+                    }
+                    return n;
+                }
+            }   // End of namespace detail
+
+            // Elements a reader should fill, named by key or csv_field, e.g. `projection{"id", "Name"}`
+            struct projection
+            {
+                projection(std::initializer_list<std::string> names) : fields(names) { }
+
+                explicit projection(std::vector<std::string> names) : fields(std::move(names)) { }
+
+                std::vector<std::string> fields;
+            };
+
+            /**
+             * Reads records written by `write_csv`/`writer<T>` into T. Header columns are mapped to
+             * elements once with a row_binder, then each field is parsed straight from the input
+             * into its element, only string fields with escapes are copied.
+             *
+             * Malformed input throws std::invalid_argument, a record with a different number of
+             * fields than the header throws std::out_of_range.
+             *
+             * With a projection only the named elements are bound, the other columns are skipped by
+             * delimiter scanning and everything after the last bound column by a scan for the end
+             * of the record, so those fields are not parsed.
+             */
+            template<typename T>
+            class reader : public reflection::detail::record_reader<reader<T>, T>
+            {
+                static_assert(cxl::reflectable<T> && !std::is_const<T>::value,
+                              "Value type must be a non-const reflectable type");
+
+                typedef reflection::detail::record_reader<reader<T>, T> base;
+
+            public:
+                using base::default_buffer_size;
+
+                reader(const char *data, std::size_t size)
+                        : base(data, size), binder_(read_header())
+                {
+                }
+
+                explicit reader(std::streambuf &sb, std::size_t buffer_size = default_buffer_size)
+                        : base(sb, buffer_size), binder_(read_header())
+                {
+                }
+
+                // Projected readers, a field with no element or no column throws std::out_of_range
+                reader(const char *data, std::size_t size, const projection &fields)
+                        : base(data, size), binder_(read_header(&fields))
+                {
+                    tail_ = bound_columns();
+                }
+
+                reader(std::streambuf &sb,
+                       const projection &fields,
+                       std::size_t buffer_size = default_buffer_size)
+                        : base(sb, buffer_size), binder_(read_header(&fields))
+                {
+                    tail_ = bound_columns();
+                }
+
+                // Reads headerless records with the column mapping of another reader
+                reader(const char *data, std::size_t size, const row_binder<T> &binder)
+                        : base(data, size), binder_(binder)
+                {
+                }
+
+                const row_binder<T> &binder() const { return binder_; }
+
+                // Start of the unread input, within the buffer of a reader over memory
+                const char *position() { return input_.pos(); }
+
+                // Parses the next record into `t`, elements with no column are left untouched,
+                // false at the end of input
+                bool read(T &t)
+                {
+                    for (;;) {
+                        const char *p = input_.pos();
+                        detail::scan_result r = detail::skip_blank(p, input_.end(), input_.eof());
+                        if (r == detail::scan_result::ok) {
+                            r = read_record(p, t);
+                        }
+                        if (r == detail::scan_result::end_of_input) {
+                            return false;
+                        }
+                        if (r == detail::scan_result::ok) {
+                            input_.pos() = p;
+                            records_++;
+                            return true;
+                        }
+                        input_.refill(input_.pos());
+                    }
+                }
+
+            private:
+                row_binder<T> read_header(const projection *fields = nullptr)
+                {
+                    std::vector<std::string> names;
+                    for (;;) {
+                        const char *p = input_.pos();
+                        detail::scan_result r = detail::skip_blank(p, input_.end(), input_.eof());
+                        bool last = false;
+                        names.clear();
+                        while (r == detail::scan_result::ok && !last) {
+                            detail::field f;
+                            r = detail::scan_field(p, input_.end(), input_.eof(), f);
+                            if (r == detail::scan_result::ok) {
+                                names.emplace_back();
+                                detail::unescape(f.data, f.size, names.back());
+                                last = f.last;
+                            }
+                        }
+                        if (r == detail::scan_result::ok) {
+                            input_.pos() = p;
+                            if (fields != nullptr) {
+                                project(names, *fields);
+                            }
+                            return row_binder<T>(names);
+                        }
+                        if (r == detail::scan_result::end_of_input) {
+                            throw std::invalid_argument("csv: missing header");
+                        }
+                        input_.refill(input_.pos());
+                    }
+                }
+
+                // Blanks the header names of the columns not in `fields`, so they stay unmapped
+                static void project(std::vector<std::string> &names, const projection &fields)
+                {
+                    std::vector<bool> wanted(cxl::tuple_size<T>::value);
+                    for (const std::string &name : fields.fields) {
+                        std::size_t n = detail::find_field<T>(name);
+                        if (n == cxl::tuple_size<T>::value) {
+                            throw std::out_of_range("csv: no element for field " + name);
+                        }
+                        wanted[n] = true;
+                    }
+                    for (std::string &name : names) {
+                        std::size_t n = detail::find_field<T>(name);
+                        if (n == cxl::tuple_size<T>::value || !wanted[n]) {
+                            name.clear();
+                        } else {
+                            wanted[n] = false;
+                        }
+                    }
+                    for (std::size_t n = 0; n < wanted.size(); n++) {
+                        if (wanted[n]) {
+                            throw std::out_of_range(std::string("csv: no column for field ")
+                                                    + get_element_descriptors<T>()[n].key);
+                        }
+                    }
+                }
+
+                // One past the last mapped column
+                std::size_t bound_columns() const
+                {
+                    std::size_t n = binder_.columns();
+                    while (n > 0 && !binder_.mapped(n - 1)) {
+                        n--;
+                    }
+                    return n;
+                }
+
+                // Parses into `t` as it goes, on need_more the record is parsed again from the start
+                detail::scan_result read_record(const char *&p, T &t)
+                {
+                    std::size_t column = 0;
+                    bool last = false;
+                    while (!last) {
+                        if (column == tail_) {
+                            return detail::skip_record(p, input_.end(), input_.eof());
+                        }
+                        detail::field f;
+                        detail::scan_result r = detail::scan_field(p, input_.end(), input_.eof(), f);
+                        if (r != detail::scan_result::ok) {
+                            return r;
+                        }
+                        if (column >= binder_.columns()) {
+                            throw std::out_of_range("csv: too many fields in record " + record_number());
+                        }
+                        if (!binder_.mapped(column)) {
+                            column++;
+                            last = f.last;
+                            continue;
+                        }
+                        try {
+                            if (f.escaped) {
+                                detail::unescape(f.data, f.size, scratch_);
+                                binder_.parse(t, column, scratch_.data(), scratch_.size());
+                            } else {
+                                binder_.parse(t, column, f.data, f.size);
+                            }
+                        } catch (std::invalid_argument &e) {
+                            throw std::invalid_argument("csv: record " + record_number() + ": " + e.what());
+                        }
+                        column++;
+                        last = f.last;
+                    }
+                    if (column != binder_.columns()) {
+                        throw std::out_of_range("csv: too few fields in record " + record_number());
+                    }
+                    return detail::scan_result::ok;
+                }
+
+                std::string record_number() const { return std::to_string(records_ + 1); }
+
+                using base::input_;
+                using base::records_;
+                row_binder<T> binder_;
+                std::string scratch_;
+                std::size_t tail_ = std::size_t(-1);    // Columns from here on are skipped unread
+            };
+
+            template<typename T>
+            std::vector<T> read_csv(const char *data, std::size_t size)
+            {
+                std::vector<T> ret;
+                reader<T>(data, size).read_all(std::back_inserter(ret));
+                return ret;
+            }
+
+            template<typename T>
+            std::vector<T> read_csv(const std::string &data)
+            {
+                return read_csv<T>(data.data(), data.size());
+            }
+
+            template<typename T>
+            std::vector<T> read_csv(std::streambuf &sb)
+            {
+                std::vector<T> ret;
+                reader<T>(sb).read_all(std::back_inserter(ret));
+                return ret;
+            }
+
+            // Only the projected elements are read, the others are value-initialized
+            template<typename T>
+            std::vector<T> read_csv(const char *data, std::size_t size, const projection &fields)
+            {
+                std::vector<T> ret;
+                reader<T>(data, size, fields).read_all(std::back_inserter(ret));
+                return ret;
+            }
+
+            template<typename T>
+            std::vector<T> read_csv(const std::string &data, const projection &fields)
+            {
+                return read_csv<T>(data.data(), data.size(), fields);
+            }
+
+            template<typename T>
+            std::vector<T> read_csv(std::streambuf &sb, const projection &fields)
+            {
+                std::vector<T> ret;
+                reader<T>(sb, fields).read_all(std::back_inserter(ret));
+                return ret;
+            }
         }
     }
 }
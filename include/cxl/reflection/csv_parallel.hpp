@@ -0,0 +1,374 @@
+#ifndef CXL_REFLECTION_CSV_PARALLEL_HPP
+#define CXL_REFLECTION_CSV_PARALLEL_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <system_error>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <cxl/mapped_file.hpp>
+#include <cxl/reflection/csv.hpp>
+#include <cxl/reflection/parallel.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace csv {
+            namespace detail {
+                // Chunks smaller than this are not worth a thread
+                constexpr std::size_t min_chunk_size = 1 << 20;
+
+                // Start of the first record after `p` in write_csv output. Writers never put a raw LF
+                // inside a field: it's escaped as '\' LF, and a '\' in the data is itself escaped as
+                // "\\", so an LF ends a record iff it follows an even run of backslashes. Other input
+                // may have raw LFs in quoted fields, see starts_record().
+                inline const char *next_record(const char *begin, const char *p, const char *end)
+                {
+                    while (p != end) {
+                        const void *found = std::memchr(p, '\n', std::size_t(end - p));
+                        const char *lf = static_cast<const char *>(found);
+                        if (lf == nullptr) {
+                            return end;
+                        }
+                        const char *q = lf;
+                        while (q != begin && q[-1] == '\\') {
+                            --q;
+                        }
+                        if ((lf - q) % 2 == 0) {
+                            return lf + 1;
+                        }
+                        p = lf + 1;
+                    }
+                    return end;
+                }
+
+                // True if [p, end) starts with a record of `columns` fields, or holds only blank lines.
+                // An LF in a quoted field is followed by the rest of that field, which almost never
+                // scans as a whole record.
+                inline bool starts_record(const char *p, const char *end, std::size_t columns)
+                {
+                    if (skip_blank(p, end, true) == scan_result::end_of_input) {
+                        return true;
+                    }
+                    std::size_t n = 0;
+                    field f;
+                    f.last = false;
+                    try {
+                        while (!f.last && n <= columns) {
+                            scan_field(p, end, true, f);
+                            n++;
+                        }
+                    } catch (std::invalid_argument &) {
+                        return false;
+                    }
+                    return n == columns;
+                }
+
+                // First boundary after `p` that passes starts_record(), or `end`
+                inline const char *record_start(const char *begin,
+                                                const char *p,
+                                                const char *end,
+                                                std::size_t columns)
+                {
+                    do {
+                        p = next_record(begin, p, end);
+                    } while (p != end && !starts_record(p, end, columns));
+                    return p;
+                }
+
+                struct streambuf_output
+                {
+                    void operator()(const char *p, std::size_t n) const
+                    {
+                        if (sb.sputn(p, std::streamsize(n)) != std::streamsize(n)) {
+                            throw std::runtime_error("csv: write failed");
+                        }
+                    }
+
+                    std::streambuf &sb;
+                };
+
+                struct fd_output
+                {
+                    void operator()(const char *p, std::size_t n) const
+                    {
+                        while (n > 0) {
+                            ssize_t k = ::write(fd, p, n);
+                            if (k < 0 && errno == EINTR) {
+                                continue;
+                            }
+                            if (k < 0) {
+                                throw std::system_error(errno, std::generic_category(), "csv: write failed");
+                            }
+                            p += k;
+                            n -= std::size_t(k);
+                        }
+                    }
+
+                    int fd;
+                };
+
+                /*
+                 * Rows are formatted in blocks of `block_rows` by `concurrency` threads, the calling
+                 * thread hands finished blocks to `out` in input order. Block k is only started once
+                 * block k - max_blocks has been written, every in-flight block owns one of
+                 * max_blocks slots and formatting reuses the capacity of the slot it replaces.
+                 */
+                template<typename RandomIt, typename Output>
+                std::size_t write_blocks(RandomIt begin,
+                                         RandomIt end,
+                                         const Output &out,
+                                         std::size_t concurrency,
+                                         std::size_t block_rows,
+                                         std::size_t max_blocks)
+                {
+                    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+                    typedef std::make_index_sequence<cxl::tuple_size<value_type>::value> indices;
+
+                    std::size_t rows = std::size_t(end - begin);
+                    std::size_t blocks = (rows + block_rows - 1) / block_rows;
+                    std::vector<std::string> slots(max_blocks);
+                    std::vector<char> ready(max_blocks, 0);
+                    std::size_t next_block = 0;
+                    std::size_t written = 0;
+                    std::exception_ptr error;
+                    std::mutex m;
+                    std::condition_variable cv;
+
+                    auto worker = [&]() {
+                        std::string buffer;
+                        std::unique_lock<std::mutex> lock(m);
+                        for (;;) {
+                            cv.wait(lock, [&] {
+                                return error || next_block >= blocks || next_block < written + max_blocks;
+                            });
+                            if (error || next_block >= blocks) {
+                                return;
+                            }
+                            std::size_t k = next_block++;
+                            lock.unlock();
+                            try {
+                                string_sink sink{buffer};
+                                RandomIt last = begin + std::ptrdiff_t(std::min(rows, (k + 1) * block_rows));
+                                for (RandomIt i = begin + std::ptrdiff_t(k * block_rows); i != last; ++i) {
+                                    write_row(sink, *i, indices());
+                                }
+                            } catch (...) {
+                                lock.lock();
+                                error = std::current_exception();
+                                cv.notify_all();
+                                return;
+                            }
+                            lock.lock();
+                            slots[k % max_blocks].swap(buffer);
+                            ready[k % max_blocks] = 1;
+                            buffer.clear();
+                            cv.notify_all();
+                        }
+                    };
+
+                    std::vector<std::thread> threads;
+                    threads.reserve(concurrency);
+                    for (std::size_t n = 0; n < concurrency; n++) {
+                        threads.emplace_back(worker);
+                    }
+
+                    std::size_t bytes = 0;
+                    std::unique_lock<std::mutex> lock(m);
+                    for (std::size_t k = 0; k < blocks && !error; k++) {
+                        std::size_t slot = k % max_blocks;
+                        cv.wait(lock, [&] { return error || ready[slot]; });
+                        if (error) {
+                            break;
+                        }
+                        // No worker touches the slot until `written` moves past k
+                        lock.unlock();
+                        try {
+                            out(slots[slot].data(), slots[slot].size());
+                        } catch (...) {
+                            lock.lock();
+                            error = std::current_exception();
+                            cv.notify_all();
+                            break;
+                        }
+                        lock.lock();
+                        bytes += slots[slot].size();
+                        slots[slot].clear();
+                        ready[slot] = 0;
+                        written = k + 1;
+                        cv.notify_all();
+                    }
+                    lock.unlock();
+
+                    for (std::thread &th : threads) {
+                        th.join();
+                    }
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                    return bytes;
+                }
+
+                template<typename RandomIt, typename Output>
+                std::size_t write_csv_parallel(RandomIt begin,
+                                               RandomIt end,
+                                               const Output &out,
+                                               bool with_header,
+                                               std::size_t concurrency,
+                                               std::size_t block_rows)
+                {
+                    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+                    static_assert(cxl::reflectable<value_type>, "Value type must be reflectable");
+                    std::size_t bytes = 0;
+                    if (with_header) {
+                        std::string header;
+                        string_sink sink{header};
+                        write_header_row<string_sink, value_type>(
+                                sink, std::make_index_sequence<cxl::tuple_size<value_type>::value>());
+                        out(header.data(), header.size());
+                        bytes = header.size();
+                    }
+                    if (concurrency == 0) {
+                        concurrency = reflection::detail::default_concurrency();
+                    }
+                    block_rows = std::max<std::size_t>(1, block_rows);
+                    return bytes + write_blocks(begin, end, out, concurrency, block_rows, 2 * concurrency);
+                }
+            }   // End of namespace detail
+
+            /**
+             * Parallel read_csv over a buffer: the records after the header are split into up to
+             * `concurrency` chunks at likely record boundaries, each chunk is parsed into its own
+             * vector by its own thread and the vectors are joined in input order.
+             *
+             * A boundary can't be told apart from an LF inside a quoted field without scanning from
+             * the start, so it's only trusted once the chunk before it parsed cleanly from a trusted
+             * start (a chunk ending inside a quoted field fails as unterminated). A failed chunk is
+             * parsed again together with the next one until that holds, so input with raw LFs in
+             * quoted fields reads the same as with read_csv, only with less parallelism.
+             *
+             * Record numbers in error messages are relative to the chunk.
+             */
+            template<typename T>
+            std::vector<T> read_csv_parallel(const char *data, std::size_t size, std::size_t concurrency = 0)
+            {
+                reader<T> header(data, size);
+                const char *begin = header.position();
+                const char *end = data + size;
+
+                if (concurrency == 0) {
+                    concurrency = reflection::detail::default_concurrency();
+                }
+                std::size_t body = std::size_t(end - begin);
+                concurrency = std::max<std::size_t>(1, std::min(concurrency, body / detail::min_chunk_size));
+
+                std::vector<const char *> bounds(concurrency + 1);
+                bounds[0] = begin;
+                bounds[concurrency] = end;
+                std::size_t columns = header.binder().columns();
+                for (std::size_t n = 1; n < concurrency; n++) {
+                    const char *guess = begin + body * n / concurrency;
+                    bounds[n] = detail::record_start(begin, std::max(guess, bounds[n - 1]), end, columns);
+                }
+
+                std::vector<std::vector<T>> parts(concurrency);
+                std::vector<std::exception_ptr> errors(concurrency);
+                // Parses the chunks from n up to m into parts[n]
+                auto parse = [&](std::size_t n, std::size_t m) {
+                    errors[n] = nullptr;
+                    try {
+                        reader<T> r(bounds[n], std::size_t(bounds[m + 1] - bounds[n]), header.binder());
+                        r.read_all(std::back_inserter(parts[n]));
+                    } catch (...) {
+                        errors[n] = std::current_exception();
+                    }
+                };
+                auto worker = [&](std::size_t n) { parse(n, n); };
+
+                std::vector<std::thread> threads;
+                threads.reserve(concurrency - 1);
+                for (std::size_t n = 1; n < concurrency; n++) {
+                    threads.emplace_back(worker, n);
+                }
+                worker(0);
+                for (std::thread &th : threads) {
+                    th.join();
+                }
+                // bounds[n] is trusted, a failed chunk absorbs the next ones until it parses
+                for (std::size_t n = 0; n < concurrency;) {
+                    std::size_t m = n;
+                    while (errors[n] && m + 1 < concurrency) {
+                        std::vector<T>().swap(parts[++m]);
+                        parts[n].clear();
+                        parse(n, m);
+                    }
+                    if (errors[n]) {
+                        std::rethrow_exception(errors[n]);
+                    }
+                    n = m + 1;
+                }
+
+                std::size_t total = 0;
+                for (const std::vector<T> &part : parts) {
+                    total += part.size();
+                }
+                std::vector<T> ret(std::move(parts[0]));
+                ret.reserve(total);
+                for (std::size_t n = 1; n < concurrency; n++) {
+                    std::move(parts[n].begin(), parts[n].end(), std::back_inserter(ret));
+                    std::vector<T>().swap(parts[n]);
+                }
+                return ret;
+            }
+
+            /**
+             * Same output as write_csv, rows are formatted in blocks of `block_rows` on `concurrency`
+             * threads and written to `sb` in input order by the calling thread. At most
+             * 2 * concurrency formatted blocks are held in memory. Returns the number of bytes written.
+             */
+            template<typename RandomIt>
+            std::size_t write_csv_parallel(RandomIt begin,
+                                           RandomIt end,
+                                           std::streambuf &sb,
+                                           bool with_header = true,
+                                           std::size_t concurrency = 0,
+                                           std::size_t block_rows = 4096)
+            {
+                return detail::write_csv_parallel(begin, end, detail::streambuf_output{sb},
+                                                  with_header, concurrency, block_rows);
+            }
+
+            // Same as above, writes to a file descriptor
+            template<typename RandomIt>
+            std::size_t write_csv_parallel(RandomIt begin,
+                                           RandomIt end,
+                                           int fd,
+                                           bool with_header = true,
+                                           std::size_t concurrency = 0,
+                                           std::size_t block_rows = 4096)
+            {
+                return detail::write_csv_parallel(begin, end, detail::fd_output{fd},
+                                                  with_header, concurrency, block_rows);
+            }
+
+            // Maps the file at `path` and reads it with read_csv_parallel
+            template<typename T>
+            std::vector<T> read_csv_file(const std::string &path, std::size_t concurrency = 0)
+            {
+                mapped_file file(path);
+                return read_csv_parallel<T>(file.data(), file.size(), concurrency);
+            }
+        }
+    }
+}
+
+#endif // CXL_REFLECTION_CSV_PARALLEL_HPP
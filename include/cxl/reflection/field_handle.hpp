@@ -0,0 +1,200 @@
+#ifndef CXL_REFLECTION_FIELD_HANDLE_HPP
+#define CXL_REFLECTION_FIELD_HANDLE_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <typeinfo>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Function pointers are stored type-erased and cast back after the type check
+            typedef void (*erased_accessor)();
+
+            template<typename T>
+            struct field_entry
+            {
+                const char *key;
+                std::size_t type_id;
+                std::size_t offset;
+                erased_accessor getter;
+                erased_accessor setter;
+            };
+
+            template<std::size_t I, typename T>
+            unrefcv<reflected_element_type<I, T>> handle_get(const T &t)
+            {
+                return reflected_element<I, T>::get(t);
+            }
+
+            template<std::size_t I, typename T>
+            void handle_set(T &t, unrefcv<reflected_element_type<I, T>> &&v)
+            {
+                reflected_element<I, T>::set(t, std::move(v));
+            }
+
+            template<std::size_t I, typename T>
+            constexpr std::enable_if_t<!std::is_const<reflected_element_type<I, T>>::value, erased_accessor>
+            handle_setter()
+            {
+                return reinterpret_cast<erased_accessor>(&handle_set<I, T>);
+            }
+
+            template<std::size_t I, typename T>
+            constexpr std::enable_if_t<std::is_const<reflected_element_type<I, T>>::value, erased_accessor>
+            handle_setter()
+            {
+                return nullptr;
+            }
+
+            template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct field_table;
+
+            template<typename T, std::size_t... I>
+            struct field_table<T, std::index_sequence<I...>>
+            {
+                // One extra entry, so that the table of an empty T is not zero-sized
+                static const field_entry<T> entries[sizeof...(I) + 1];
+            };
+
+            template<typename T, std::size_t... I>
+            const field_entry<T> field_table<T, std::index_sequence<I...>>::entries[sizeof...(I) + 1] = {
+                    {reflected_element<I, T>::key(),
+                     which_bounded_type<to_variant_t<T>, unrefcv<reflected_element_type<I, T>>>,
+                     get_element_offset<I, T>(),
+                     reinterpret_cast<erased_accessor>(&handle_get<I, T>),
+                     handle_setter<I, T>()}...,
+                    {nullptr, 0, 0, nullptr, nullptr}
+            };
+        } // End of namespace detail
+
+        /**
+         * A field of T resolved once by index or key, then applied to any number of objects.
+         *
+         * `get<U>`/`set` only check U against the element type id, plain members of standard-layout
+         * types are loaded and stored directly by byte offset, others go through the typed
+         * getter/setter. Neither path constructs a `to_variant_t<T>`.
+         */
+        template<typename T>
+        class field_handle
+        {
+            static_assert(reflectable<T> && !std::is_const<T>::value,
+                          "field_handle requires a non-const reflectable type");
+
+            typedef detail::field_entry<T> entry_type;
+            typedef detail::field_table<T> table_type;
+
+        public:
+            typedef to_variant_t<T> variant_type;
+
+            static constexpr std::size_t npos = std::size_t(-1);
+
+            explicit field_handle(std::size_t n)
+                    : index_(n)
+            {
+                if (n >= tuple_size<T>::value) {
+                    throw std::out_of_range("field_handle");
+                }
+                entry_ = table_type::entries[n];
+            }
+
+            explicit field_handle(const std::string &key)
+                    : index_(npos)
+            {
+                for (std::size_t n = 0; n < tuple_size<T>::value; n++) {
+                    if (key == table_type::entries[n].key) {
+                        index_ = n;
+                        entry_ = table_type::entries[n];
+                        return;
+                    }
+                }
+                throw std::out_of_range("field_handle");
+            }
+
+            std::size_t index() const { return index_; }
+
+            const char *key() const { return entry().key; }
+
+            // Index of the element type in variant_type
+            std::size_t type_id() const { return entry().type_id; }
+
+            // Byte offset of the member, npos if it's accessed through getter/setter
+            std::size_t offset() const { return entry().offset; }
+
+            bool direct() const { return entry().offset != npos; }
+
+            bool readonly() const { return entry().setter == nullptr; }
+
+            template<typename U>
+            bool holds() const
+            {
+                return entry().type_id == which_bounded_type<variant_type, U>;
+            }
+
+            template<typename U>
+            U get(const T &t) const
+            {
+                check<U>();
+                const entry_type &e = entry();
+                if (e.offset != npos) {
+                    return *reinterpret_cast<const U *>(reinterpret_cast<const char *>(&t) + e.offset);
+                }
+                return reinterpret_cast<U (*)(const T &)>(e.getter)(t);
+            }
+
+            template<typename V>
+            void set(T &t, V &&v) const
+            {
+                typedef unrefcv<V> U;
+                check<U>();
+                const entry_type &e = entry();
+                if (e.setter == nullptr) {
+                    throw std::bad_cast();
+                }
+                if (e.offset != npos) {
+                    *reinterpret_cast<U *>(reinterpret_cast<char *>(&t) + e.offset) = std::forward<V>(v);
+                    return;
+                }
+                reinterpret_cast<void (*)(T &, U &&)>(e.setter)(t, U(std::forward<V>(v)));
+            }
+
+        private:
+            const entry_type &entry() const { return entry_; }
+
+            template<typename U>
+            void check() const
+            {
+                static_assert(variant_type::template is_this_type<U>::value, "type is not an element type of T");
+                if (!holds<U>()) {
+                    throw bad_get("field_handle: element type does not match requested type");
+                }
+            }
+
+            std::size_t index_;
+            entry_type entry_;
+        };
+
+        template<typename T>
+        constexpr std::size_t field_handle<T>::npos;
+
+        template<typename T>
+        field_handle<T> make_field_handle(std::size_t n)
+        {
+            return field_handle<T>(n);
+        }
+
+        template<typename T>
+        field_handle<T> make_field_handle(const std::string &key)
+        {
+            return field_handle<T>(key);
+        }
+    } // End of namespace cxl::reflection
+    using reflection::field_handle;
+    using reflection::make_field_handle;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_FIELD_HANDLE_HPP
@@ -0,0 +1,341 @@
+#ifndef CXL_REFLECTION_FLATTEN_HPP
+#define CXL_REFLECTION_FLATTEN_HPP
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <array>
+#include <utility>
+#include <stdexcept>
+#include <typeinfo>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/key_index.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Reflected members of these types are kept as leaves, they have no meaningful keys
+            template<typename T>
+            struct is_composite : bool_t<reflectable<T>>
+            {
+            };
+
+            template<typename... T>
+            struct is_composite<std::tuple<T...>> : bool_t<false>
+            {
+            };
+
+            template<typename T, typename U>
+            struct is_composite<std::pair<T, U>> : bool_t<false>
+            {
+            };
+
+            template<typename T, std::size_t N>
+            struct is_composite<std::array<T, N>> : bool_t<false>
+            {
+            };
+        } // End of namespace detail
+
+        /**
+         * A leaf reached from T through the chain of element indices P..., its path is the dotted
+         * concatenation of the keys along the chain, e.g. "m4.m1".
+         */
+        template<typename T, std::size_t... P>
+        struct flat_path;
+
+        template<typename T, std::size_t I>
+        struct flat_path<T, I>
+        {
+            typedef reflected_element<I, T> element;
+            typedef T owner_type;
+            typedef reflected_element_type<I, T> type;
+            static constexpr std::size_t leaf_index = I;
+            static constexpr std::size_t depth = 1;
+            static constexpr std::size_t length = detail::key_length(element::key());
+            static constexpr std::size_t offset = get_element_offset<I, T>();
+            static constexpr bool readonly = std::is_const<type>::value;
+
+            static constexpr char at(std::size_t i) { return element::key()[i]; }
+
+            static decltype(auto) get(const T &t) { return element::get(t); }
+
+            template<typename V>
+            static void set(T &t, V &&v)
+            {
+                element::set(t, std::forward<V>(v));
+            }
+        };
+
+        template<typename T, std::size_t I, std::size_t J, std::size_t... Rest>
+        struct flat_path<T, I, J, Rest...>
+        {
+            typedef reflected_element<I, T> element;
+            typedef reflected_element_type<I, T> member_type;
+            typedef flat_path<uncv<member_type>, J, Rest...> next;
+            typedef typename next::owner_type owner_type;
+            typedef cond<std::is_const<member_type>::value,
+                         add_const<typename next::type>,
+                         typename next::type> type;
+            static constexpr std::size_t leaf_index = next::leaf_index;
+            static constexpr std::size_t depth = 1 + next::depth;
+            static constexpr std::size_t key_length = detail::key_length(element::key());
+            static constexpr std::size_t length = key_length + 1 + next::length;
+            static constexpr std::size_t offset = get_element_offset<I, T>() != std::size_t(-1)
+                                                  && next::offset != std::size_t(-1)
+                                                  ? get_element_offset<I, T>() + next::offset
+                                                  : std::size_t(-1);
+            static constexpr bool readonly = std::is_const<member_type>::value || next::readonly;
+
+            static constexpr char at(std::size_t i)
+            {
+                return i < key_length ? element::key()[i]
+                                      : i == key_length ? '.' : next::at(i - key_length - 1);
+            }
+
+            static decltype(auto) get(const T &t) { return next::get(element::get(t)); }
+
+            template<typename V>
+            static void set(T &t, V &&v)
+            {
+                next::set(element::get(t), std::forward<V>(v));
+            }
+        };
+
+        namespace detail {
+            template<typename... L>
+            struct concat_paths;
+
+            template<>
+            struct concat_paths<>
+            {
+                typedef std::tuple<> type;
+            };
+
+            template<typename... P>
+            struct concat_paths<std::tuple<P...>>
+            {
+                typedef std::tuple<P...> type;
+            };
+
+            template<typename... P, typename... Q, typename... L>
+            struct concat_paths<std::tuple<P...>, std::tuple<Q...>, L...>
+                    : concat_paths<std::tuple<P..., Q...>, L...>
+            {
+            };
+
+            template<typename Root,
+                     typename T,
+                     typename Prefix,
+                     typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct flatten;
+
+            template<typename Root, typename Prefix, bool Composite>
+            struct flatten_element;
+
+            template<typename Root, std::size_t... P>
+            struct flatten_element<Root, std::index_sequence<P...>, false>
+            {
+                typedef std::tuple<flat_path<Root, P...>> type;
+            };
+
+            template<typename Root, std::size_t... P>
+            struct flatten_element<Root, std::index_sequence<P...>, true>
+                    : flatten<Root, uncv<typename flat_path<Root, P...>::type>, std::index_sequence<P...>>
+            {
+            };
+
+            // Members kept by value (getter/setter attributes) are leaves even if composite
+            template<std::size_t I, typename T>
+            using is_nested = bool_t<!reflected_element<I, T>::use_value
+                                     && is_composite<uncv<reflected_element_type<I, T>>>::value>;
+
+            template<typename Root, typename T, std::size_t... P, std::size_t... I>
+            struct flatten<Root, T, std::index_sequence<P...>, std::index_sequence<I...>>
+                    : concat_paths<typename flatten_element<Root,
+                                                            std::index_sequence<P..., I>,
+                                                            is_nested<I, T>::value>::type...>
+            {
+            };
+        } // End of namespace detail
+
+        // std::tuple of the flat_path of every leaf of T, in depth-first order
+        template<typename T>
+        using flat_paths = typename detail::flatten<T, T, std::index_sequence<>>::type;
+
+        template<typename T>
+        struct flat_size : uint_t<std::tuple_size<flat_paths<T>>::value>
+        {
+        };
+
+        template<std::size_t J, typename T>
+        using flat_element = std::tuple_element_t<J, flat_paths<T>>;
+
+        struct flat_descriptor
+        {
+            std::size_t index;
+            const char *path;
+            std::size_t depth;
+            bool readonly;
+            std::size_t offset;                 // From the start of T, std::size_t(-1) if unknown
+            const element_descriptor *leaf;     // Descriptor of the leaf in its owner type
+        };
+
+        namespace detail {
+            template<typename Path, typename Seq = std::make_index_sequence<Path::length>>
+            struct path_string;
+
+            template<typename Path, std::size_t... C>
+            struct path_string<Path, std::index_sequence<C...>>
+            {
+                static constexpr char value[sizeof...(C) + 1] = {Path::at(C)..., '\0'};
+            };
+
+            template<typename Path, std::size_t... C>
+            constexpr char path_string<Path, std::index_sequence<C...>>::value[sizeof...(C) + 1];
+
+            template<typename T, typename Variant, typename Path, typename = void>
+            struct flat_access
+            {
+                static Variant get(const T &t) { return Variant(Path::get(t)); }
+
+                static void set(T &t, const Variant &v)
+                {
+                    Path::set(t, v.template get<unrefcv<typename Path::type>>());
+                }
+
+                static void move(T &t, Variant &&v)
+                {
+                    Path::set(t, std::move(v).template get<unrefcv<typename Path::type>>());
+                }
+            };
+
+            template<typename T, typename Variant, typename Path>
+            struct flat_access<T, Variant, Path, std::enable_if_t<Path::readonly>>
+            {
+                static Variant get(const T &t) { return Variant(Path::get(t)); }
+
+                static void set(T &, const Variant &) { throw std::bad_cast(); }
+
+                static void move(T &, Variant &&) { throw std::bad_cast(); }
+            };
+
+            template<typename T,
+                     typename Paths = flat_paths<T>,
+                     typename Seq = std::make_index_sequence<std::tuple_size<Paths>::value>>
+            struct flat_table;
+
+            template<typename T, typename... Path, std::size_t... J>
+            struct flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>
+            {
+                typedef to_variant_t<std::tuple<typename Path::type...>> Variant;
+                typedef Variant (*getter_type)(const T &);
+                typedef void (*setter_type)(T &, const Variant &);
+                typedef void (*mover_type)(T &, Variant &&);
+
+                // One extra entry, so that the tables of a T without leaves are not zero-sized
+                static constexpr flat_descriptor elements[sizeof...(J) + 1] = {
+                        {J,
+                         path_string<Path>::value,
+                         Path::depth,
+                         Path::readonly,
+                         Path::offset,
+                         &get_element_descriptors<typename Path::owner_type>()[Path::leaf_index]}...,
+                        flat_descriptor{}
+                };
+
+                static constexpr getter_type getters[sizeof...(J) + 1]
+                        = {&flat_access<T, Variant, Path>::get..., nullptr};
+                static constexpr setter_type setters[sizeof...(J) + 1]
+                        = {&flat_access<T, Variant, Path>::set..., nullptr};
+                static constexpr mover_type movers[sizeof...(J) + 1]
+                        = {&flat_access<T, Variant, Path>::move..., nullptr};
+            };
+
+            template<typename T, typename... Path, std::size_t... J>
+            constexpr flat_descriptor
+                    flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::elements[sizeof...(J) + 1];
+
+            template<typename T, typename... Path, std::size_t... J>
+            constexpr typename flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::getter_type
+                    flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::getters[sizeof...(J) + 1];
+
+            template<typename T, typename... Path, std::size_t... J>
+            constexpr typename flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::setter_type
+                    flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::setters[sizeof...(J) + 1];
+
+            template<typename T, typename... Path, std::size_t... J>
+            constexpr typename flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::mover_type
+                    flat_table<T, std::tuple<Path...>, std::index_sequence<J...>>::movers[sizeof...(J) + 1];
+        } // End of namespace detail
+
+        // Variant of all leaf types, the flat counterpart of to_variant_t
+        template<typename T>
+        using flat_variant_t = typename detail::flat_table<T>::Variant;
+
+        template<typename T>
+        constexpr const flat_descriptor *get_flat_descriptors()
+        {
+            return detail::flat_table<uncv<T>>::elements;
+        }
+
+        template<typename T>
+        constexpr const flat_descriptor &get_flat_descriptor(std::size_t n)
+        {
+            return n < flat_size<uncv<T>>::value ? get_flat_descriptors<T>()[n]
+                                                 : throw std::out_of_range("get_flat_descriptor");
+        }
+
+        // Index of the leaf with dotted path `path`, like index_of an unknown path fails to compile
+        template<typename T>
+        constexpr std::size_t flat_index_of(const char *path)
+        {
+            const flat_descriptor *d = get_flat_descriptors<T>();
+            std::size_t n = 0;
+            while (n < flat_size<uncv<T>>::value && !detail::key_equal(d[n].path, path)) {
+                n++;
+            }
+            return n < flat_size<uncv<T>>::value ? n : throw std::out_of_range("flat_index_of");
+        }
+
+        template<typename T>
+        std::enable_if_t<reflectable<T>, flat_variant_t<T>> get_flat_variant(std::size_t n, const T &t)
+        {
+            if (n >= flat_size<T>::value) {
+                throw std::out_of_range("get_flat_variant");
+            }
+            return detail::flat_table<T>::getters[n](t);
+        }
+
+        template<typename T>
+        std::enable_if_t<reflectable<T>> set_flat(std::size_t n, T &t, const flat_variant_t<T> &v)
+        {
+            if (n >= flat_size<T>::value) {
+                throw std::out_of_range("set_flat");
+            }
+            detail::flat_table<T>::setters[n](t, v);
+        }
+
+        template<typename T>
+        std::enable_if_t<reflectable<T>> set_flat(std::size_t n, T &t, flat_variant_t<T> &&v)
+        {
+            if (n >= flat_size<T>::value) {
+                throw std::out_of_range("set_flat");
+            }
+            detail::flat_table<T>::movers[n](t, std::move(v));
+        }
+    } // End of namespace cxl::reflection
+    using reflection::flat_path;
+    using reflection::flat_paths;
+    using reflection::flat_size;
+    using reflection::flat_element;
+    using reflection::flat_variant_t;
+    using reflection::flat_descriptor;
+    using reflection::get_flat_descriptors;
+    using reflection::get_flat_descriptor;
+    using reflection::flat_index_of;
+    using reflection::get_flat_variant;
+    using reflection::set_flat;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_FLATTEN_HPP
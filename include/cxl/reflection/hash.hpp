@@ -0,0 +1,401 @@
+#ifndef CXL_REFLECTION_HASH_HPP
+#define CXL_REFLECTION_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/member_runs.hpp>
+#include <cxl/reflection/value_kind.hpp>
+
+namespace cxl {
+    namespace reflection {
+        template<typename T>
+        std::enable_if_t<reflectable<T>, std::size_t> hash_value(const T &t);
+
+        template<typename T>
+        std::enable_if_t<reflectable<T>, bool> equal(const T &a, const T &b);
+
+        namespace detail {
+            constexpr std::uint64_t hash_seed = 0x9e3779b97f4a7c15ull;
+
+            inline std::uint64_t hash_mix(std::uint64_t h, std::uint64_t v)
+            {
+                h = (h ^ v) * 0xbf58476d1ce4e5b9ull;
+                return h ^ (h >> 31);
+            }
+
+            // Final avalanche, so every input bit affects the low bits used for bucketing
+            inline std::uint64_t hash_finish(std::uint64_t h)
+            {
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33;
+                h *= 0xc4ceb93fe53a87d3ull;
+                return h ^ (h >> 33);
+            }
+
+            inline std::uint64_t hash_bytes(std::uint64_t h, const char *p, std::size_t n)
+            {
+                h = hash_mix(h, n);
+                for (; n >= 8; p += 8, n -= 8) {
+                    std::uint64_t v;
+                    std::memcpy(&v, p, 8);
+                    h = hash_mix(h, v);
+                }
+                if (n > 0) {
+                    std::uint64_t v = 0;
+                    std::memcpy(&v, p, n);
+                    h = hash_mix(h, v);
+                }
+                return h;
+            }
+
+            // Types whose equal values always have equal object representations
+            template<typename U>
+            using is_bytewise_type = bool_t<std::is_integral<U>::value
+                                            || std::is_enum<U>::value
+                                            || std::is_pointer<U>::value>;
+
+            template<typename U>
+            using is_bytewise_member_type = is_bytewise_type<uncv<U>>;
+
+            // How hash_value/equal handle a member: by value, as the start of a run of adjacent
+            // bytewise members hashed and compared as one block, or not at all because it's in such a run
+            template<std::size_t I, typename T>
+            using member_kind = raw_member_kind<is_bytewise_member_type, I, T>;
+
+            template<std::size_t I, typename T>
+            using run_end = raw_run_end<is_bytewise_member_type, I, T>;
+
+            // Containers other than strings, compared and hashed element by element
+            template<typename U>
+            using is_hashed_range = bool_t<!reflectable<U> && is_range<U>::value && !is_string<U>::value>;
+
+            // Unordered containers, whose iteration order doesn't take part in equality
+            template<typename U, typename = void>
+            struct is_unordered : bool_t<false>
+            {
+            };
+
+            template<typename U>
+            struct is_unordered<U, decltype((void) std::declval<typename U::hasher>())> : bool_t<true>
+            {
+            };
+
+            template<typename U>
+            std::enable_if_t<is_hashed_range<U>::value, std::uint64_t> hash_of(const U &v);
+
+            template<typename... U>
+            std::uint64_t hash_of(const cxl::variant<U...> &v);
+
+            template<typename U>
+            std::enable_if_t<is_hashed_range<U>::value, bool> equal_of(const U &a, const U &b);
+
+            template<typename... U>
+            bool equal_of(const cxl::variant<U...> &a, const cxl::variant<U...> &b);
+
+            template<typename U>
+            std::enable_if_t<reflectable<U>, std::uint64_t> hash_of(const U &v)
+            {
+                return hash_value(v);
+            }
+
+            template<typename U>
+            std::enable_if_t<!reflectable<U> && is_bytewise_type<U>::value && !std::is_pointer<U>::value,
+                             std::uint64_t>
+            hash_of(const U &v)
+            {
+                return static_cast<std::uint64_t>(v);
+            }
+
+            template<typename U>
+            std::uint64_t hash_of(U *v)
+            {
+                return reinterpret_cast<std::uintptr_t>(v);
+            }
+
+            template<typename U>
+            std::enable_if_t<!reflectable<U> && std::is_floating_point<U>::value, std::uint64_t>
+            hash_of(const U &v)
+            {
+                // -0.0 == 0.0, so they must hash the same
+                return v == 0 ? 0 : std::hash<U>()(v);
+            }
+
+            template<typename C, typename Tr, typename A>
+            std::uint64_t hash_of(const std::basic_string<C, Tr, A> &v)
+            {
+                return hash_bytes(hash_seed,
+                                  reinterpret_cast<const char *>(v.data()),
+                                  v.size() * sizeof(C));
+            }
+
+            template<typename U>
+            std::enable_if_t<!reflectable<U>
+                             && !is_bytewise_type<U>::value
+                             && !std::is_floating_point<U>::value
+                             && !is_hashed_range<U>::value
+                             && !is_variant<U>::value, std::uint64_t>
+            hash_of(const U &v)
+            {
+                return std::hash<U>()(v);
+            }
+
+            // Unordered containers combine their element hashes order-independently
+            template<typename U>
+            std::uint64_t range_hash(const U &v, bool_t<true>)
+            {
+                std::uint64_t sum = 0;
+                for (const auto &e : v) {
+                    sum += hash_finish(hash_of(e));
+                }
+                return hash_mix(hash_mix(hash_seed, v.size()), sum);
+            }
+
+            template<typename U>
+            std::uint64_t range_hash(const U &v, bool_t<false>)
+            {
+                std::uint64_t h = hash_seed;
+                std::size_t n = 0;
+                for (const auto &e : v) {
+                    h = hash_mix(h, hash_of(e));
+                    ++n;
+                }
+                return hash_mix(h, n);
+            }
+
+            template<typename U>
+            std::enable_if_t<is_hashed_range<U>::value, std::uint64_t> hash_of(const U &v)
+            {
+                return range_hash(v, is_unordered<U>());
+            }
+
+            template<typename K, typename V>
+            std::uint64_t hash_of(const std::pair<const K, V> &v)
+            {
+                return hash_mix(hash_mix(hash_seed, hash_of(v.first)), hash_of(v.second));
+            }
+
+            struct alternative_hasher
+            {
+                template<typename U>
+                std::uint64_t operator()(const U &u) const
+                {
+                    return hash_of(u);
+                }
+            };
+
+            // The index of the current alternative, then its value; an empty variant only its index
+            template<typename... U>
+            std::uint64_t hash_of(const cxl::variant<U...> &v)
+            {
+                std::uint64_t h = hash_mix(hash_seed, v.which());
+                return v.which() >= sizeof...(U) ? h : hash_mix(h, v.apply_visitor(alternative_hasher()));
+            }
+
+            template<typename U>
+            std::enable_if_t<reflectable<U>, bool> equal_of(const U &a, const U &b)
+            {
+                return equal(a, b);
+            }
+
+            template<typename U>
+            std::enable_if_t<!reflectable<U> && !is_hashed_range<U>::value && !is_variant<U>::value, bool>
+            equal_of(const U &a, const U &b)
+            {
+                return a == b;
+            }
+
+            template<typename K, typename V>
+            bool equal_of(const std::pair<const K, V> &a, const std::pair<const K, V> &b)
+            {
+                return equal_of(a.first, b.first) && equal_of(a.second, b.second);
+            }
+
+            // The element of an unordered container equal to e, looked up by its key
+            template<typename U>
+            bool contains_equal(const U &v, const typename U::key_type &e)
+            {
+                auto i = v.find(e);
+                return i != v.end() && equal_of(*i, e);
+            }
+
+            template<typename U>
+            bool contains_equal(const U &v,
+                                const std::pair<const typename U::key_type, typename U::mapped_type> &e)
+            {
+                auto i = v.find(e.first);
+                return i != v.end() && equal_of(i->second, e.second);
+            }
+
+            // Unordered containers are equal if each element of one has an equal counterpart in the
+            // other; keys are matched by the container's own hash and key_equal, so multi-containers
+            // aren't supported
+            template<typename U>
+            bool range_equal(const U &a, const U &b, bool_t<true>)
+            {
+                if (a.size() != b.size()) {
+                    return false;
+                }
+                for (const auto &e : a) {
+                    if (!contains_equal(b, e)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            template<typename U>
+            bool range_equal(const U &a, const U &b, bool_t<false>)
+            {
+                auto i = std::begin(a);
+                auto j = std::begin(b);
+                for (; i != std::end(a) && j != std::end(b); ++i, ++j) {
+                    if (!equal_of(*i, *j)) {
+                        return false;
+                    }
+                }
+                return i == std::end(a) && j == std::end(b);
+            }
+
+            template<typename U>
+            std::enable_if_t<is_hashed_range<U>::value, bool> equal_of(const U &a, const U &b)
+            {
+                return range_equal(a, b, is_unordered<U>());
+            }
+
+            template<typename V>
+            struct alternative_comparer
+            {
+                template<typename U>
+                bool operator()(const U &u) const
+                {
+                    return equal_of(u, other.template get<U>());
+                }
+
+                const V &other;
+            };
+
+            template<typename... U>
+            bool equal_of(const cxl::variant<U...> &a, const cxl::variant<U...> &b)
+            {
+                if (a.which() != b.which()) {
+                    return false;
+                }
+                typedef cxl::variant<U...> V;
+                return a.which() >= sizeof...(U) || a.apply_visitor(alternative_comparer<V>{b});
+            }
+
+            template<std::size_t I, typename T>
+            std::uint64_t hash_element(std::uint64_t h, const T &t, by_value)
+            {
+                return hash_mix(h, hash_of(reflected_element<I, T>::get(t)));
+            }
+
+            template<std::size_t I, typename T>
+            std::uint64_t hash_element(std::uint64_t h, const T &t, run_start)
+            {
+                constexpr std::size_t begin = get_element_offset<I, T>();
+                const char *p = reinterpret_cast<const char *>(&t) + begin;
+                return hash_bytes(h, p, run_end<I, T>::value - begin);
+            }
+
+            template<std::size_t I, typename T>
+            std::uint64_t hash_element(std::uint64_t h, const T &, in_run)
+            {
+                return h;
+            }
+
+            template<std::size_t I, typename T>
+            bool equal_element(const T &a, const T &b, by_value)
+            {
+                return equal_of(reflected_element<I, T>::get(a), reflected_element<I, T>::get(b));
+            }
+
+            template<std::size_t I, typename T>
+            bool equal_element(const T &a, const T &b, run_start)
+            {
+                constexpr std::size_t begin = get_element_offset<I, T>();
+                return std::memcmp(reinterpret_cast<const char *>(&a) + begin,
+                                   reinterpret_cast<const char *>(&b) + begin,
+                                   run_end<I, T>::value - begin) == 0;
+            }
+
+            template<std::size_t I, typename T>
+            bool equal_element(const T &, const T &, in_run)
+            {
+                return true;
+            }
+
+            template<typename T, std::size_t... I>
+            std::uint64_t hash_elements(const T &t, std::index_sequence<I...>)
+            {
+                std::uint64_t h = hash_seed;
+                typedef int expander[];
+                (void) expander{0, (h = hash_element<I>(h, t, member_kind<I, T>()), 0)...};
+                return h;
+            }
+
+            template<typename T, std::size_t... I>
+            bool equal_elements(const T &a, const T &b, std::index_sequence<I...>)
+            {
+                bool r = true;
+                typedef int expander[];
+                (void) expander{0, (r = r && equal_element<I>(a, b, member_kind<I, T>()), 0)...};
+                return r;
+            }
+        } // End of namespace detail
+
+        /**
+         * Memberwise hash of a reflectable value. Runs of adjacent integral, enum and pointer members
+         * with no padding in between are hashed as one block of bytes, other members by value,
+         * reflectable members, containers and cxl::variant recursively.
+         */
+        template<typename T>
+        std::enable_if_t<reflectable<T>, std::size_t> hash_value(const T &t)
+        {
+            std::uint64_t h = detail::hash_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+            return static_cast<std::size_t>(detail::hash_finish(h));
+        }
+
+        // Memberwise equality, consistent with hash_value
+        template<typename T>
+        std::enable_if_t<reflectable<T>, bool> equal(const T &a, const T &b)
+        {
+            return detail::equal_elements(a, b, std::make_index_sequence<tuple_size<T>::value>());
+        }
+
+        // Hash and key-equal functors for unordered containers, e.g.
+        // std::unordered_set<S, cxl::reflected_hash<S>, cxl::reflected_equal_to<S>>
+        template<typename T>
+        struct reflected_hash
+        {
+            std::size_t operator()(const T &t) const { return hash_value(t); }
+        };
+
+        template<typename T>
+        struct reflected_equal_to
+        {
+            bool operator()(const T &a, const T &b) const { return equal(a, b); }
+        };
+    } // End of namespace cxl::reflection
+    using reflection::hash_value;
+    using reflection::equal;
+    using reflection::reflected_hash;
+    using reflection::reflected_equal_to;
+} // End of namespace cxl
+
+// Specializes std::hash for a reflectable type, must be put in global namespace
+#define CXL_REFLECTED_STD_HASH(TYPE)                                                               \
+    namespace std {                                                                                \
+        template <>                                                                                \
+        struct hash<TYPE> : ::cxl::reflection::reflected_hash<TYPE> {};                            \
+    }
+
+#endif // CXL_REFLECTION_HASH_HPP
@@ -0,0 +1,1226 @@
+#ifndef CXL_REFLECTION_JSON_HPP
+#define CXL_REFLECTION_JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/row_binder.hpp>
+#include <cxl/reflection/key_index.hpp>
+#include <cxl/reflection/text_input.hpp>
+#include <cxl/reflection/text_sink.hpp>
+#include <cxl/reflection/value_kind.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace json {
+            namespace detail {
+                using reflection::detail::find_escape;
+                using reflection::detail::string_sink;
+                using reflection::detail::buffer_sink;
+                using reflection::detail::format_unsigned;
+                using reflection::detail::format_integer;
+                using reflection::detail::float_format;
+                using reflection::detail::format_float;
+                using reflection::detail::unsupported_kind;
+                using reflection::detail::null_kind;
+                using reflection::detail::bool_kind;
+                using reflection::detail::integer_kind;
+                using reflection::detail::enum_kind;
+                using reflection::detail::float_kind;
+                using reflection::detail::string_kind;
+                using reflection::detail::variant_kind;
+                using reflection::detail::tuple_kind;
+                using reflection::detail::object_kind;
+                using reflection::detail::map_kind;
+                using reflection::detail::range_kind;
+                using reflection::detail::value_kind;
+                using reflection::detail::parsed_type;
+
+                constexpr char hex_digits[] = "0123456789abcdef";
+
+                // Length of `s` as the inside of a JSON string
+                constexpr std::size_t escaped_size(const char *s)
+                {
+                    std::size_t n = 0;
+                    for (; *s != '\0'; ++s) {
+                        unsigned char c = static_cast<unsigned char>(*s);
+                        n += c == '"' || c == '\\' ? 2 : c < 32 ? 6 : 1;
+                    }
+                    return n;
+                }
+
+                template<std::size_t N>
+                struct fragment
+                {
+                    char data[N];
+                };
+
+                // `,"key":` with the key escaped, the comma only if `comma`
+                template<std::size_t N>
+                constexpr fragment<N> make_fragment(const char *key, bool comma)
+                {
+                    fragment<N> f{};
+                    std::size_t n = 0;
+                    if (comma) {
+                        f.data[n++] = ',';
+                    }
+                    f.data[n++] = '"';
+                    for (; *key != '\0'; ++key) {
+                        unsigned char c = static_cast<unsigned char>(*key);
+                        if (c == '"' || c == '\\') {
+                            f.data[n++] = '\\';
+                            f.data[n++] = char(c);
+                        } else if (c < 32) {
+                            f.data[n++] = '\\';
+                            f.data[n++] = 'u';
+                            f.data[n++] = '0';
+                            f.data[n++] = '0';
+                            f.data[n++] = hex_digits[c >> 4];
+                            f.data[n++] = hex_digits[c & 15];
+                        } else {
+                            f.data[n++] = char(c);
+                        }
+                    }
+                    f.data[n++] = '"';
+                    f.data[n++] = ':';
+                    return f;
+                }
+
+                // Pre-escaped key of the I-th element of T with its separators, built at compile time
+                template<std::size_t I, typename T>
+                struct key_fragment
+                {
+                    static constexpr std::size_t size
+                            = (I > 0 ? 1 : 0) + escaped_size(reflection::detail::get_json_key<I, T>()) + 3;
+                    static constexpr fragment<size> value
+                            = make_fragment<size>(reflection::detail::get_json_key<I, T>(), I > 0);
+                };
+
+                template<std::size_t I, typename T>
+                constexpr fragment<key_fragment<I, T>::size> key_fragment<I, T>::value;
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, const T &t);
+
+                // A JSON string, clean runs are found by find_escape and appended as a whole
+                template<typename Sink>
+                void write_string(Sink &sink, const char *s, std::size_t n)
+                {
+                    sink.put('"');
+                    const char *end = s + n;
+                    while (s != end) {
+                        const char *run = s;
+                        s = find_escape(s, end);
+                        sink.append(run, std::size_t(s - run));
+                        if (s == end) {
+                            break;
+                        }
+                        unsigned char c = static_cast<unsigned char>(*s++);
+                        char esc[6] = {'\\', char(c), '0', '0', '0', '0'};
+                        switch (c) {
+                            case '"':
+                            case '\\':
+                                sink.append(esc, 2);
+                                break;
+                            case '\n':
+                                sink.append("\\n", 2);
+                                break;
+                            case '\r':
+                                sink.append("\\r", 2);
+                                break;
+                            case '\t':
+                                sink.append("\\t", 2);
+                                break;
+                            case '\b':
+                                sink.append("\\b", 2);
+                                break;
+                            case '\f':
+                                sink.append("\\f", 2);
+                                break;
+                            default:
+                                esc[1] = 'u';
+                                esc[4] = hex_digits[c >> 4];
+                                esc[5] = hex_digits[c & 15];
+                                sink.append(esc, 6);
+                        }
+                    }
+                    sink.put('"');
+                }
+
+                template<typename Sink>
+                void write_value(Sink &sink, std::nullptr_t, null_kind)
+                {
+                    sink.append("null", 4);
+                }
+
+                template<typename Sink>
+                void write_value(Sink &sink, bool t, bool_kind)
+                {
+                    if (t) {
+                        sink.append("true", 4);
+                    } else {
+                        sink.append("false", 5);
+                    }
+                }
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, T t, integer_kind)
+                {
+                    char buf[24];
+                    char *p = format_integer(t, buf + sizeof(buf));
+                    sink.append(p, std::size_t(buf + sizeof(buf) - p));
+                }
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, T t, enum_kind)
+                {
+                    write_value(sink, static_cast<std::underlying_type_t<T>>(t), integer_kind());
+                }
+
+                // NaN and infinities have no JSON representation, they are written as null
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, T t, float_kind)
+                {
+                    if (!std::isfinite(t)) {
+                        sink.append("null", 4);
+                        return;
+                    }
+                    char buf[48];
+                    sink.append(buf, format_float(t, buf));
+                }
+
+                template<typename Sink, typename Traits, typename Allocator>
+                void write_value(Sink &sink, const std::basic_string<char, Traits, Allocator> &t, string_kind)
+                {
+                    write_string(sink, t.data(), t.size());
+                }
+
+                template<typename Sink>
+                void write_value(Sink &sink, const char *t, string_kind)
+                {
+                    if (t == nullptr) {
+                        sink.append("null", 4);
+                    } else {
+                        write_string(sink, t, std::strlen(t));
+                    }
+                }
+
+                template<typename Sink>
+                struct variant_writer
+                {
+                    template<typename U>
+                    void operator()(const U &u) const
+                    {
+                        write_value(sink, u);
+                    }
+
+                    Sink &sink;
+                };
+
+                // The current alternative, untagged, an empty variant is null
+                template<typename Sink, typename... U>
+                void write_value(Sink &sink, const cxl::variant<U...> &t, variant_kind)
+                {
+                    if (t.which() >= sizeof...(U)) {
+                        sink.append("null", 4);
+                    } else {
+                        t.apply_visitor(variant_writer<Sink>{sink});
+                    }
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void write_elements(Sink &sink, const T &t, std::index_sequence<I...>, tuple_kind)
+                {
+                    sink.put('[');
+                    typedef int expander[];
+                    (void) expander{0, ((I > 0 ? sink.put(',') : void()),
+                                        write_value(sink, reflected_element<I, T>::get(t)), 0)...};
+                    sink.put(']');
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void write_elements(Sink &sink, const T &t, std::index_sequence<I...>, object_kind)
+                {
+                    sink.put('{');
+                    typedef int expander[];
+                    (void) expander{0, (sink.append(key_fragment<I, T>::value.data, key_fragment<I, T>::size),
+                                        write_value(sink, reflected_element<I, T>::get(t)), 0)...};
+                    sink.put('}');
+                }
+
+                template<typename Sink, typename T, typename Kind>
+                std::enable_if_t<Kind::value == tuple_kind::value || Kind::value == object_kind::value>
+                write_value(Sink &sink, const T &t, Kind kind)
+                {
+                    write_elements(sink, t, std::make_index_sequence<tuple_size<T>::value>(), kind);
+                }
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, const T &t, map_kind)
+                {
+                    sink.put('{');
+                    bool first = true;
+                    for (const auto &e : t) {
+                        if (!first) {
+                            sink.put(',');
+                        }
+                        first = false;
+                        write_value(sink, e.first, string_kind());
+                        sink.put(':');
+                        write_value(sink, e.second);
+                    }
+                    sink.put('}');
+                }
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, const T &t, range_kind)
+                {
+                    sink.put('[');
+                    bool first = true;
+                    for (const auto &e : t) {
+                        if (!first) {
+                            sink.put(',');
+                        }
+                        first = false;
+                        write_value(sink, e);
+                    }
+                    sink.put(']');
+                }
+
+                template<typename Sink, typename T>
+                void write_value(Sink &sink, const T &t)
+                {
+                    static_assert(value_kind<uncv<T>>::value != unsupported_kind::value,
+                                  "Type cannot be written as JSON");
+                    write_value(sink, t, value_kind<uncv<T>>());
+                }
+            }   // End of namespace detail
+
+            /**
+             * Buffered JSON output to a streambuf. Reflectable types are written as objects keyed by
+             * json_key() (which falls back to key()), std::tuple/pair/array and other containers as
+             * arrays, string keyed maps as objects and cxl::variant as its current alternative.
+             * Floating point numbers are written with the fewest digits that read back exactly.
+             */
+            class writer
+            {
+            public:
+                static constexpr std::size_t default_buffer_size = 1 << 16;
+
+                writer(std::streambuf &sb, char *buffer, std::size_t size) : sink_(sb, buffer, size) { }
+
+                explicit writer(std::streambuf &sb)
+                        : own_(new char[default_buffer_size]), sink_(sb, own_.get(), default_buffer_size)
+                {
+                }
+
+                writer(const writer &) = delete;
+
+                writer &operator=(const writer &) = delete;
+
+                ~writer()
+                {
+                    try {
+                        sink_.flush();
+                    } catch (...) {
+                    }
+                }
+
+                template<typename T>
+                void write(const T &t)
+                {
+                    detail::write_value(sink_, t);
+                }
+
+                // Raw text between values, e.g. '\n' for JSON lines
+                void put(char c) { sink_.put(c); }
+
+                void flush() { sink_.flush(); }
+
+                // Bytes written so far, including the ones still in the buffer
+                std::size_t size() const { return sink_.size(); }
+
+            private:
+                std::unique_ptr<char[]> own_;
+                detail::buffer_sink sink_;
+            };
+
+            // Appends the JSON text of `t` to `out`
+            template<typename T>
+            void write_json(std::string &out, const T &t)
+            {
+                detail::string_sink sink{out};
+                detail::write_value(sink, t);
+            }
+
+            template<typename T>
+            std::string to_json(const T &t)
+            {
+                std::string ret;
+                write_json(ret, t);
+                return ret;
+            }
+
+            // Returns the number of bytes written
+            template<typename T>
+            std::size_t write_json(std::streambuf &sb, const T &t)
+            {
+                writer w(sb);
+                w.write(t);
+                w.flush();
+                return w.size();
+            }
+
+            namespace detail {
+                using reflection::detail::key_length;
+
+                // The json_keys of T, for key_index
+                template<typename T>
+                struct json_keys
+                {
+                    static constexpr std::size_t size = tuple_size<T>::value;
+
+                    static constexpr const char *key(std::size_t i)
+                    {
+                        return get_element_descriptors<T>()[i].json_key;
+                    }
+
+                    static constexpr std::size_t length(std::size_t i) { return key_length(key(i)); }
+                };
+
+                // Perfect hash of the json_keys of T
+                template<typename T>
+                using key_index = reflection::detail::key_index<json_keys<T>>;
+
+                class parser;
+
+                struct element_reader;
+
+                // Element parsers by element index
+                template<typename T>
+                using element_parsers = reflection::detail::element_reader_table<element_reader, T>;
+
+                /**
+                 * Recursive descent over JSON text in memory, straight into the target values. Syntax
+                 * errors and values that don't fit their target throw std::invalid_argument.
+                 */
+                class parser
+                {
+                public:
+                    parser(const char *begin, const char *end) : begin_(begin), p_(begin), end_(end) { }
+
+                    template<typename T>
+                    void parse(T &t)
+                    {
+                        static_assert(value_kind<T>::value != unsupported_kind::value
+                                      && !std::is_pointer<T>::value, "Type cannot be parsed from JSON");
+                        skip_ws();
+                        parse_value(t, value_kind<T>());
+                    }
+
+                    // Skips one value of any type, only checking what's needed to find its end
+                    void skip_value()
+                    {
+                        skip_ws();
+                        if (p_ == end_) {
+                            fail("unexpected end of input");
+                        }
+                        switch (*p_) {
+                            case '"':
+                                skip_string();
+                                break;
+                            case '{':
+                            case '[':
+                                skip_container();
+                                break;
+                            case 't':
+                                literal("true", 4);
+                                break;
+                            case 'f':
+                                literal("false", 5);
+                                break;
+                            case 'n':
+                                literal("null", 4);
+                                break;
+                            default:
+                                bool integral;
+                                p_ = scan_number(integral);
+                        }
+                    }
+
+                    // Only whitespace may follow
+                    void finish()
+                    {
+                        skip_ws();
+                        if (p_ != end_) {
+                            fail("unexpected character after the value");
+                        }
+                    }
+
+                    void skip_ws()
+                    {
+                        while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+                            ++p_;
+                        }
+                    }
+
+                    const char *position() const { return p_; }
+
+                    [[noreturn]] void fail(const char *what) const
+                    {
+                        throw std::invalid_argument(std::string("json: ") + what + " at offset "
+                                                    + std::to_string(p_ - begin_));
+                    }
+
+                private:
+                    void expect(char c)
+                    {
+                        skip_ws();
+                        if (p_ == end_ || *p_ != c) {
+                            fail(c == ':' ? "expected ':'" : c == '[' ? "expected '['" : "expected '{'");
+                        }
+                        ++p_;
+                    }
+
+                    // Consumes ',' and returns true, or consumes `close` and returns false
+                    bool next(char close)
+                    {
+                        skip_ws();
+                        if (p_ != end_ && *p_ == ',') {
+                            ++p_;
+                            return true;
+                        }
+                        if (p_ != end_ && *p_ == close) {
+                            ++p_;
+                            return false;
+                        }
+                        fail(close == ']' ? "expected ',' or ']'" : "expected ',' or '}'");
+                    }
+
+                    // After the opening bracket: true and consumes `close` if the container is empty
+                    bool empty(char close)
+                    {
+                        skip_ws();
+                        if (p_ != end_ && *p_ == close) {
+                            ++p_;
+                            return true;
+                        }
+                        return false;
+                    }
+
+                    void literal(const char *s, std::size_t n)
+                    {
+                        if (std::size_t(end_ - p_) < n || std::memcmp(p_, s, n) != 0) {
+                            fail("invalid literal");
+                        }
+                        p_ += n;
+                    }
+
+                    bool at(char c) const { return p_ != end_ && *p_ == c; }
+
+                    // End of the number at p_, checked against the JSON grammar
+                    const char *scan_number(bool &integral) const
+                    {
+                        const char *q = p_;
+                        integral = true;
+                        if (q != end_ && *q == '-') {
+                            ++q;
+                        }
+                        const char *digits = q;
+                        while (q != end_ && unsigned(*q - '0') <= 9) {
+                            ++q;
+                        }
+                        if (q == digits || (*digits == '0' && q - digits > 1)) {
+                            fail("invalid number");
+                        }
+                        if (q != end_ && *q == '.') {
+                            integral = false;
+                            digits = ++q;
+                            while (q != end_ && unsigned(*q - '0') <= 9) {
+                                ++q;
+                            }
+                            if (q == digits) {
+                                fail("invalid number");
+                            }
+                        }
+                        if (q != end_ && (*q == 'e' || *q == 'E')) {
+                            integral = false;
+                            ++q;
+                            if (q != end_ && (*q == '+' || *q == '-')) {
+                                ++q;
+                            }
+                            digits = q;
+                            while (q != end_ && unsigned(*q - '0') <= 9) {
+                                ++q;
+                            }
+                            if (q == digits) {
+                                fail("invalid number");
+                            }
+                        }
+                        return q;
+                    }
+
+                    void skip_string()
+                    {
+                        ++p_;
+                        for (;;) {
+                            p_ = find_escape(p_, end_);
+                            if (p_ == end_) {
+                                fail("unterminated string");
+                            }
+                            if (*p_ == '"') {
+                                ++p_;
+                                return;
+                            }
+                            if (*p_ != '\\' || end_ - p_ < 2) {
+                                fail("invalid character in string");
+                            }
+                            p_ += 2;
+                        }
+                    }
+
+                    void skip_container()
+                    {
+                        std::size_t depth = 0;
+                        do {
+                            if (p_ == end_) {
+                                fail("unterminated array or object");
+                            }
+                            char c = *p_;
+                            if (c == '"') {
+                                skip_string();
+                                continue;
+                            }
+                            depth += c == '{' || c == '[' ? 1 : 0;
+                            depth -= c == '}' || c == ']' ? 1 : 0;
+                            ++p_;
+                        } while (depth > 0);
+                    }
+
+                    int hex4()
+                    {
+                        if (end_ - p_ < 4) {
+                            fail("invalid \\u escape");
+                        }
+                        int v = 0;
+                        for (int i = 0; i < 4; i++) {
+                            char c = *p_++;
+                            int d = c >= '0' && c <= '9' ? c - '0'
+                                    : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                                    : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                            if (d < 0) {
+                                fail("invalid \\u escape");
+                            }
+                            v = v * 16 + d;
+                        }
+                        return v;
+                    }
+
+                    // One escape sequence after the backslash at p_, appended to `out` as UTF-8
+                    template<typename String>
+                    void unescape(String &out)
+                    {
+                        if (end_ - p_ < 2) {
+                            fail("unterminated string");
+                        }
+                        char c = p_[1];
+                        p_ += 2;
+                        switch (c) {
+                            case '"':
+                            case '\\':
+                            case '/':
+                                out.push_back(c);
+                                return;
+                            case 'b':
+                                out.push_back('\b');
+                                return;
+                            case 'f':
+                                out.push_back('\f');
+                                return;
+                            case 'n':
+                                out.push_back('\n');
+                                return;
+                            case 'r':
+                                out.push_back('\r');
+                                return;
+                            case 't':
+                                out.push_back('\t');
+                                return;
+                            case 'u':
+                                break;
+                            default:
+                                fail("invalid escape");
+                        }
+                        // A surrogate is only valid as the high half of a pair, UTF-8 can't encode it alone
+                        const char *escape = p_ - 2;
+                        unsigned long cp = unsigned(hex4());
+                        if (cp >= 0xD800 && cp < 0xE000) {
+                            if (cp >= 0xDC00 || end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                                p_ = escape;
+                                fail("invalid \\u escape");
+                            }
+                            p_ += 2;
+                            unsigned long lo = unsigned(hex4());
+                            if (lo < 0xDC00 || lo >= 0xE000) {
+                                p_ = escape;
+                                fail("invalid \\u escape");
+                            }
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        }
+                        if (cp < 0x80) {
+                            out.push_back(char(cp));
+                        } else if (cp < 0x800) {
+                            out.push_back(char(0xC0 | (cp >> 6)));
+                            out.push_back(char(0x80 | (cp & 0x3F)));
+                        } else if (cp < 0x10000) {
+                            out.push_back(char(0xE0 | (cp >> 12)));
+                            out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+                            out.push_back(char(0x80 | (cp & 0x3F)));
+                        } else {
+                            out.push_back(char(0xF0 | (cp >> 18)));
+                            out.push_back(char(0x80 | ((cp >> 12) & 0x3F)));
+                            out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+                            out.push_back(char(0x80 | (cp & 0x3F)));
+                        }
+                    }
+
+                    // The string at p_, clean runs are found by find_escape and appended as a whole
+                    template<typename String>
+                    void parse_string(String &out)
+                    {
+                        if (!at('"')) {
+                            fail("expected a string");
+                        }
+                        ++p_;
+                        for (;;) {
+                            const char *run = p_;
+                            p_ = find_escape(p_, end_);
+                            out.append(run, std::size_t(p_ - run));
+                            if (p_ == end_) {
+                                fail("unterminated string");
+                            }
+                            if (*p_ == '"') {
+                                ++p_;
+                                return;
+                            }
+                            if (*p_ != '\\') {
+                                fail("invalid character in string");
+                            }
+                            unescape(out);
+                        }
+                    }
+
+                    // An object key: points into the input unless it has escapes
+                    void parse_key(const char *&key, std::size_t &n)
+                    {
+                        skip_ws();
+                        if (!at('"')) {
+                            fail("expected a key");
+                        }
+                        const char *start = p_ + 1;
+                        const char *q = find_escape(start, end_);
+                        if (q != end_ && *q == '"') {
+                            key = start;
+                            n = std::size_t(q - start);
+                            p_ = q + 1;
+                            return;
+                        }
+                        key_.clear();
+                        parse_string(key_);
+                        key = key_.data();
+                        n = key_.size();
+                    }
+
+                    void parse_value(std::nullptr_t &, null_kind)
+                    {
+                        literal("null", 4);
+                    }
+
+                    void parse_value(bool &t, bool_kind)
+                    {
+                        if (at('t')) {
+                            literal("true", 4);
+                            t = true;
+                        } else {
+                            literal("false", 5);
+                            t = false;
+                        }
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, integer_kind)
+                    {
+                        bool integral;
+                        const char *q = scan_number(integral);
+                        if (!integral || !reflection::detail::parse_text(p_, q, t)) {
+                            fail("number does not fit an integer");
+                        }
+                        p_ = q;
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, enum_kind)
+                    {
+                        std::underlying_type_t<T> v;
+                        parse_value(v, integer_kind());
+                        t = static_cast<T>(v);
+                    }
+
+                    // null, as written for NaN and infinities, reads as NaN
+                    template<typename T>
+                    void parse_value(T &t, float_kind)
+                    {
+                        if (at('n')) {
+                            literal("null", 4);
+                            t = std::numeric_limits<T>::quiet_NaN();
+                            return;
+                        }
+                        bool integral;
+                        const char *q = scan_number(integral);
+                        if (!reflection::detail::parse_text(p_, q, t)) {
+                            fail("invalid number");
+                        }
+                        p_ = q;
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, string_kind)
+                    {
+                        t.clear();
+                        parse_string(t);
+                    }
+
+                    template<typename U, typename V>
+                    bool parse_alternative(V &v, const char *start)
+                    {
+                        typedef unwrap_type<U> A;
+                        p_ = start;
+                        try {
+                            A a{};
+                            parse(a);
+                            v = std::move(a);
+                            return true;
+                        } catch (std::invalid_argument &) {
+                            return false;
+                        }
+                    }
+
+                    // Alternatives are tried in order, the first that parses is kept
+                    template<typename... U>
+                    void parse_value(cxl::variant<U...> &t, variant_kind)
+                    {
+                        const char *start = p_;
+                        bool done = false;
+                        typedef int expander[];
+                        (void) expander{0, (done = done || parse_alternative<U>(t, start), 0)...};
+                        if (!done) {
+                            p_ = start;
+                            fail("no alternative of the variant matches");
+                        }
+                    }
+
+                    template<typename T, std::size_t... I>
+                    void parse_elements(T &t, std::index_sequence<I...>)
+                    {
+                        typedef int expander[];
+                        (void) expander{0, ((I > 0 ? expect_comma() : void()),
+                                            parse(reflected_element<I, T>::get(t)), 0)...};
+                    }
+
+                    void expect_comma()
+                    {
+                        skip_ws();
+                        if (!at(',')) {
+                            fail("expected ','");
+                        }
+                        ++p_;
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, tuple_kind)
+                    {
+                        expect('[');
+                        parse_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+                        skip_ws();
+                        if (!at(']')) {
+                            fail("expected ']'");
+                        }
+                        ++p_;
+                    }
+
+                    // Members missing from the object are left untouched, unknown keys are skipped
+                    template<typename T>
+                    void parse_value(T &t, object_kind)
+                    {
+                        expect('{');
+                        if (empty('}')) {
+                            return;
+                        }
+                        do {
+                            const char *key;
+                            std::size_t n;
+                            parse_key(key, n);
+                            expect(':');
+                            std::size_t i = key_index<T>::find(key, n);
+                            if (i < tuple_size<T>::value) {
+                                element_parsers<T>::readers[i](*this, t);
+                            } else {
+                                skip_value();
+                            }
+                        } while (next('}'));
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, map_kind)
+                    {
+                        expect('{');
+                        t.clear();
+                        if (empty('}')) {
+                            return;
+                        }
+                        do {
+                            typename T::key_type key;
+                            skip_ws();
+                            parse_string(key);
+                            expect(':');
+                            typename T::mapped_type value{};
+                            parse(value);
+                            t.emplace(std::move(key), std::move(value));
+                        } while (next('}'));
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, range_kind)
+                    {
+                        expect('[');
+                        t.clear();
+                        if (empty(']')) {
+                            return;
+                        }
+                        do {
+                            typename parsed_type<typename T::value_type>::type value{};
+                            parse(value);
+                            t.insert(t.end(), std::move(value));
+                        } while (next(']'));
+                    }
+
+                    const char *begin_;
+                    const char *p_;
+                    const char *end_;
+                    std::string key_;
+                };
+
+                // Readonly elements are skipped, elements with a setter are parsed into a temporary
+                struct element_reader
+                {
+                    typedef parser input_type;
+
+                    template<typename U>
+                    static void read(parser &in, U &v)
+                    {
+                        in.parse(v);
+                    }
+
+                    static void skip(parser &in) { in.skip_value(); }
+                };
+            }   // End of namespace detail
+
+            /**
+             * Parses JSON text straight into `t`, with no intermediate document: object keys are
+             * matched to elements through a compile-time perfect hash of T's json_keys, unknown keys
+             * are skipped, members missing from the text are left untouched, containers are replaced.
+             * Malformed text or values that don't fit their target throw std::invalid_argument.
+             */
+            template<typename T>
+            void parse(const char *data, std::size_t size, T &t)
+            {
+                detail::parser in(data, data + size);
+                in.parse(t);
+                in.finish();
+            }
+
+            template<typename T>
+            void parse(const std::string &text, T &t)
+            {
+                parse(text.data(), text.size(), t);
+            }
+
+            template<typename T>
+            T parse(const char *data, std::size_t size)
+            {
+                T t{};
+                parse(data, size, t);
+                return t;
+            }
+
+            template<typename T>
+            T parse(const std::string &text)
+            {
+                return parse<T>(text.data(), text.size());
+            }
+
+            // How json::reader finds its records: `array` is a top-level array of them, `lines` is a
+            // sequence of whitespace-separated values such as JSON lines, `automatic` takes a leading
+            // '[' as an array unless a record can be an array itself, in which case it's `lines`
+            enum class stream_format
+            {
+                automatic, lines, array
+            };
+
+            namespace detail {
+                using reflection::detail::scan_result;
+                using reflection::detail::input;
+
+                // True if a T is written as a JSON array, so a '[' may start a record
+                template<typename T, typename Kind = value_kind<T>>
+                struct is_array_like
+                        : bool_t<Kind::value == tuple_kind::value || Kind::value == range_kind::value>
+                {
+                };
+
+                template<typename... U>
+                struct is_array_like<cxl::variant<U...>, variant_kind>
+                        : or_<is_array_like<unwrap_type<U>>::value...>
+                {
+                };
+
+                inline bool is_space(char c)
+                {
+                    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+                }
+
+                // Past the closing quote of the string whose contents start at `p`, nullptr if it
+                // does not end before `end`
+                inline const char *string_end(const char *p, const char *end)
+                {
+                    for (;;) {
+                        p = find_escape(p, end);
+                        if (p == end) {
+                            return nullptr;
+                        }
+                        if (*p == '"') {
+                            return p + 1;
+                        }
+                        p += *p == '\\' ? 2 : 1;
+                        if (p > end) {
+                            return nullptr;
+                        }
+                    }
+                }
+
+                /*
+                 * Finds the end of the value starting at `p` by counting brackets outside strings,
+                 * without checking it. need_more if it may continue past `end`; at the end of input an
+                 * incomplete value is returned whole and left for the parser to reject.
+                 */
+                inline scan_result value_end(const char *p, const char *end, bool eof, const char *&stop)
+                {
+                    std::size_t depth = 0;
+                    while (p != end) {
+                        char c = *p;
+                        if (c == '"') {
+                            p = string_end(p + 1, end);
+                            if (p == nullptr) {
+                                break;
+                            }
+                        } else if (c == '{' || c == '[') {
+                            ++depth;
+                            ++p;
+                        } else if (c == '}' || c == ']') {
+                            if (depth == 0) {
+                                // Not a value, left for the parser to reject
+                                stop = p;
+                                return scan_result::ok;
+                            }
+                            --depth;
+                            ++p;
+                        } else if (depth == 0 && (c == ',' || is_space(c))) {
+                            // End of a number or literal
+                            stop = p;
+                            return scan_result::ok;
+                        } else {
+                            ++p;
+                        }
+                        if (depth == 0 && (c == '"' || c == '}' || c == ']')) {
+                            stop = p;
+                            return scan_result::ok;
+                        }
+                    }
+                    if (!eof) {
+                        return scan_result::need_more;
+                    }
+                    stop = end;
+                    return scan_result::ok;
+                }
+            }   // End of namespace detail
+
+            /**
+             * Reads a stream of JSON values one record at a time, either a top-level array of
+             * records or whitespace-separated records such as JSON lines, as chosen by the
+             * stream_format. Input comes from memory or from a streambuf through a fixed buffer that
+             * only grows for a record larger than itself, so memory use doesn't depend on the size of
+             * the input. Each record is parsed like json::parse, members missing from it are left
+             * untouched by read(), errors throw std::invalid_argument.
+             */
+            template<typename T>
+            class reader : public reflection::detail::record_reader<reader<T>, T>
+            {
+                typedef reflection::detail::record_reader<reader<T>, T> base;
+                friend base;
+
+            public:
+                using base::default_buffer_size;
+
+                reader(const char *data, std::size_t size, stream_format format = stream_format::automatic)
+                        : base(data, size), state_(initial_state(format))
+                {
+                }
+
+                explicit reader(std::streambuf &sb,
+                                std::size_t buffer_size = default_buffer_size,
+                                stream_format format = stream_format::automatic)
+                        : base(sb, buffer_size), state_(initial_state(format))
+                {
+                }
+
+            private:
+                enum state_type
+                {
+                    start, array_start, array_first, array_next, values, done
+                };
+
+                static state_type initial_state(stream_format format)
+                {
+                    return format == stream_format::array ? array_start
+                           : format == stream_format::lines || detail::is_array_like<T>::value ? values
+                           : start;
+                }
+
+                // Skips whitespace and separators up to the next record, states change only when the
+                // position they apply to is committed to input_
+                detail::scan_result next(const char *&p)
+                {
+                    const char *end = input_.end();
+                    for (;;) {
+                        while (p != end && detail::is_space(*p)) {
+                            ++p;
+                        }
+                        if (p == end) {
+                            if (!input_.eof()) {
+                                return detail::scan_result::need_more;
+                            }
+                            if (state_ == array_start) {
+                                fail("expected '['");
+                            }
+                            if (state_ == array_first || state_ == array_next) {
+                                fail("unterminated array");
+                            }
+                            return detail::scan_result::end_of_input;
+                        }
+                        switch (state_) {
+                            case start:
+                            case array_start:
+                                if (state_ == array_start && *p != '[') {
+                                    fail("expected '['");
+                                }
+                                state_ = *p == '[' ? array_first : values;
+                                p += state_ == array_first ? 1 : 0;
+                                input_.pos() = p;
+                                continue;
+                            case array_first:
+                            case array_next:
+                                if (*p == ']') {
+                                    state_ = done;
+                                    input_.pos() = ++p;
+                                    continue;
+                                }
+                                if (state_ == array_next) {
+                                    if (*p != ',') {
+                                        fail("expected ',' or ']'");
+                                    }
+                                    ++p;
+                                    while (p != end && detail::is_space(*p)) {
+                                        ++p;
+                                    }
+                                    if (p == end) {
+                                        if (input_.eof()) {
+                                            fail("unterminated array");
+                                        }
+                                        return detail::scan_result::need_more;
+                                    }
+                                }
+                                return detail::scan_result::ok;
+                            case values:
+                                return detail::scan_result::ok;
+                            case done:
+                                fail("unexpected character after the array");
+                        }
+                    }
+                }
+
+                // Bounds of the next record, for record_reader::read()
+                detail::scan_result scan_record(const char *&begin, const char *&end)
+                {
+                    begin = input_.pos();
+                    detail::scan_result r = next(begin);
+                    end = begin;
+                    if (r == detail::scan_result::ok) {
+                        r = detail::value_end(begin, input_.end(), input_.eof(), end);
+                    }
+                    return r;
+                }
+
+                void parse_record(const char *begin, const char *end, T &t)
+                {
+                    try {
+                        detail::parser in(begin, end);
+                        in.parse(t);
+                        in.finish();
+                    } catch (std::invalid_argument &e) {
+                        // Parser messages start with "json: "
+                        throw std::invalid_argument("json: record " + std::to_string(records_ + 1) + ": "
+                                                    + (e.what() + 6));
+                    }
+                    state_ = state_ == values ? values : array_next;
+                }
+
+                [[noreturn]] void fail(const char *what) const
+                {
+                    throw std::invalid_argument(std::string("json: ") + what + " after record "
+                                                + std::to_string(records_));
+                }
+
+                using base::input_;
+                using base::records_;
+                state_type state_;
+            };
+
+            // Calls `f(T &&)` with each record read from `sb`, returns the number of records
+            template<typename T, typename F>
+            std::size_t for_each_record(std::streambuf &sb,
+                                        F &&f,
+                                        stream_format format = stream_format::automatic)
+            {
+                return reader<T>(sb, reader<T>::default_buffer_size, format).for_each(std::forward<F>(f));
+            }
+        }
+    }
+    namespace json = reflection::json;
+}
+
+#endif // CXL_REFLECTION_JSON_HPP
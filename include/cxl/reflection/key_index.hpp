@@ -0,0 +1,146 @@
+#ifndef CXL_REFLECTION_KEY_INDEX_HPP
+#define CXL_REFLECTION_KEY_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Compile time perfect hashing of element keys, shared by the parsers
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Length of a key, usable in constant expressions
+            constexpr std::size_t key_length(const char *s)
+            {
+                std::size_t n = 0;
+                while (s[n] != '\0') {
+                    n++;
+                }
+                return n;
+            }
+
+            // FNV-1a of [s, s + n) under `seed`, folded so the low bits depend on all of it
+            constexpr std::uint64_t key_hash(const char *s, std::size_t n, std::uint64_t seed)
+            {
+                std::uint64_t h = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+                for (std::size_t i = 0; i < n; i++) {
+                    h ^= static_cast<unsigned char>(s[i]);
+                    h *= 1099511628211ULL;
+                }
+                return h ^ (h >> 32);
+            }
+
+            constexpr std::size_t pow2_at_least(std::size_t n)
+            {
+                std::size_t m = 1;
+                while (m < n) {
+                    m *= 2;
+                }
+                return m;
+            }
+
+            template<std::size_t N, std::size_t M, std::size_t B>
+            struct key_hash_table
+            {
+                std::uint32_t seeds[B];         // Per bucket
+                std::uint32_t slots[M];         // Element index + 1, 0 if free
+                std::uint32_t lengths[N + 1];   // Of the keys, by element index
+            };
+
+            /*
+             * Perfect hash of the keys of Keys::key(i) / Keys::length(i), i < Keys::size, built at compile
+             * time by hash and displace: a key's bucket is picked by key_hash(key, 0), then each bucket,
+             * largest first, gets the first seed under which all its keys land on distinct free slots.
+             * Duplicate keys are a compile error. A lookup is two hashes and one key comparison.
+             */
+            template<typename Keys>
+            struct key_index
+            {
+                static constexpr std::size_t size = Keys::size;
+                static constexpr std::size_t slot_count = pow2_at_least(2 * size);
+                static constexpr std::size_t bucket_count = slot_count > 1 ? slot_count / 2 : 1;
+                typedef key_hash_table<size, slot_count, bucket_count> table_type;
+
+                static constexpr table_type build()
+                {
+                    table_type t{};
+                    std::size_t bucket[size + 1] = {};
+                    std::size_t first[bucket_count + 1] = {};
+                    std::size_t largest = 0;
+                    for (std::size_t i = 0; i < size; i++) {
+                        t.lengths[i] = std::uint32_t(Keys::length(i));
+                        bucket[i] = key_hash(Keys::key(i), t.lengths[i], 0) & (bucket_count - 1);
+                        first[bucket[i] + 1]++;
+                    }
+                    // Element indices grouped by bucket, bucket b is [first[b], first[b + 1])
+                    for (std::size_t b = 0; b < bucket_count; b++) {
+                        largest = first[b + 1] > largest ? first[b + 1] : largest;
+                        first[b + 1] += first[b];
+                    }
+                    std::size_t order[size + 1] = {};
+                    std::size_t filled[bucket_count] = {};
+                    for (std::size_t i = 0; i < size; i++) {
+                        order[first[bucket[i]] + filled[bucket[i]]++] = i;
+                    }
+                    for (std::size_t s = largest; s > 0; s--) {
+                        for (std::size_t b = 0; b < bucket_count; b++) {
+                            if (first[b + 1] - first[b] != s) {
+                                continue;
+                            }
+                            std::uint32_t seed = 1;
+                            while (!place(t, order + first[b], s, seed)) {
+                                if (++seed == 1u << 16) {
+                                    throw std::logic_error("key_index: duplicate key");
+                                }
+                            }
+                            t.seeds[b] = seed;
+                        }
+                    }
+                    return t;
+                }
+
+                // Puts the `n` keys of a bucket in their slots under `seed`, unless one is taken
+                static constexpr bool place(table_type &t,
+                                            const std::size_t *keys,
+                                            std::size_t n,
+                                            std::uint32_t seed)
+                {
+                    for (std::size_t k = 0; k < n; k++) {
+                        std::size_t i = keys[k];
+                        std::size_t slot = key_hash(Keys::key(i), t.lengths[i], seed) & (slot_count - 1);
+                        if (t.slots[slot] != 0) {
+                            // Takes back the slots of the keys placed so far
+                            for (std::size_t j = 0; j < k; j++) {
+                                std::uint64_t h = key_hash(Keys::key(keys[j]), t.lengths[keys[j]], seed);
+                                t.slots[h & (slot_count - 1)] = 0;
+                            }
+                            return false;
+                        }
+                        t.slots[slot] = std::uint32_t(i + 1);
+                    }
+                    return true;
+                }
+
+                static constexpr table_type table = build();
+
+                // Index of the key equal to [key, key + n), size if there is none
+                static std::size_t find(const char *key, std::size_t n)
+                {
+                    std::uint32_t seed = table.seeds[key_hash(key, n, 0) & (bucket_count - 1)];
+                    std::uint32_t e = table.slots[key_hash(key, n, seed) & (slot_count - 1)];
+                    if (e == 0 || table.lengths[e - 1] != n
+                        || std::memcmp(Keys::key(e - 1), key, n) != 0) {
+                        return size;
+                    }
+                    return e - 1;
+                }
+            };
+
+            template<typename Keys>
+            constexpr typename key_index<Keys>::table_type key_index<Keys>::table;
+        } // End of namespace cxl::reflection::detail
+    } // End of namespace cxl::reflection
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_KEY_INDEX_HPP
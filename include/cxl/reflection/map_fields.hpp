@@ -0,0 +1,138 @@
+#ifndef CXL_REFLECTION_MAP_FIELDS_HPP
+#define CXL_REFLECTION_MAP_FIELDS_HPP
+
+#include <cstddef>
+#include <utility>
+#include <initializer_list>
+#include <type_traits>
+#include <cxl/reflection/reflection_impl.hpp>
+
+namespace cxl {
+    namespace reflection {
+        template<typename Dst, typename Src>
+        Dst map_fields(Src &&src);
+
+        /**
+         * Conversion used by map_fields when no hook is given, called as `conv(value, meta)` where
+         * `meta` is the reflected_element of the destination member. Values are passed through
+         * when implicitly convertible, reflectable values are mapped recursively.
+         */
+        struct default_conversion
+        {
+            template<typename V, typename Meta>
+            std::enable_if_t<std::is_convertible<V &&, unrefcv<typename Meta::type>>::value, V &&>
+            operator()(V &&v, Meta) const
+            {
+                return std::forward<V>(v);
+            }
+
+            template<typename V, typename Meta>
+            std::enable_if_t<!std::is_convertible<V &&, unrefcv<typename Meta::type>>::value
+                             && reflectable<unrefcv<V>> && reflectable<unrefcv<typename Meta::type>>,
+                             unrefcv<typename Meta::type>>
+            operator()(V &&v, Meta) const
+            {
+                return map_fields<unrefcv<typename Meta::type>>(std::forward<V>(v));
+            }
+        };
+
+        namespace detail {
+            // Index of the element of Src with the same key() as the J-th element of Dst, elements with
+            // empty keys (tuples, arrays) never match
+            template<std::size_t J, typename Dst, typename Src>
+            constexpr std::size_t source_index()
+            {
+                return reflected_element<J, Dst>::key()[0] == '\0'
+                       ? tuple_size<Src>::value
+                       : find_key<Src>(reflected_element<J, Dst>::key());
+            }
+
+            template<std::size_t J, typename Dst, typename Src>
+            using is_mapped = bool_t<!std::is_const<reflected_element_type<J, Dst>>::value
+                                     && (source_index<J, Dst, uncv<Src>>() < tuple_size<Src>::value)>;
+
+            template<std::size_t J, typename Dst, typename Src, typename Conv>
+            std::enable_if_t<!is_mapped<J, Dst, unref<Src>>::value> map_element(Dst &, Src &&, Conv &)
+            {
+            }
+
+            template<std::size_t J, typename Dst, typename Src, typename Conv>
+            std::enable_if_t<is_mapped<J, Dst, unref<Src>>::value> map_element(Dst &dst, Src &&src, Conv &conv)
+            {
+                constexpr std::size_t I = source_index<J, Dst, unrefcv<Src>>();
+                typedef reflected_element<I, unref<Src>> source;
+                typedef reflected_element<J, Dst> target;
+                target::set(dst, conv(source::get(std::forward<Src>(src)), target()));
+            }
+
+            constexpr std::size_t count_of(std::initializer_list<bool> values)
+            {
+                std::size_t n = 0;
+                for (bool v : values) {
+                    n += v ? 1 : 0;
+                }
+                return n;
+            }
+
+            template<typename Dst, typename Src, typename Conv, std::size_t... J>
+            void map_elements(Dst &dst, Src &&src, Conv &conv, std::index_sequence<J...>)
+            {
+                typedef int expander[];
+                (void) expander{0, (map_element<J>(dst, std::forward<Src>(src), conv), 0)...};
+            }
+        } // End of namespace detail
+
+        // Number of members of Dst that map_fields assigns from Src
+        template<typename Dst, typename Src, typename Seq = std::make_index_sequence<tuple_size<Dst>::value>>
+        struct mapped_count;
+
+        template<typename Dst, typename Src, std::size_t... J>
+        struct mapped_count<Dst, Src, std::index_sequence<J...>>
+                : uint_t<detail::count_of({detail::is_mapped<J, Dst, Src>::value...})>
+        {
+        };
+
+        /**
+         * Assigns every writable member of `dst` from the member of `src` with the same key(), the
+         * matching is resolved at compile time so this compiles to plain member assignments, or
+         * moves if `src` is an rvalue. `conv(value, meta)` converts each value before assignment.
+         */
+        template<typename Dst, typename Src, typename Conv>
+        void assign_fields(Dst &dst, Src &&src, Conv &&conv)
+        {
+            static_assert(reflectable<unrefcv<Src>> && reflectable<Dst>,
+                          "assign_fields requires reflectable types");
+            detail::map_elements(dst, std::forward<Src>(src), conv,
+                                 std::make_index_sequence<tuple_size<Dst>::value>());
+        }
+
+        template<typename Dst, typename Src>
+        void assign_fields(Dst &dst, Src &&src)
+        {
+            assign_fields(dst, std::forward<Src>(src), default_conversion());
+        }
+
+        // Value-initializes a Dst and assigns its members with assign_fields
+        template<typename Dst, typename Src, typename Conv>
+        Dst map_fields(Src &&src, Conv &&conv)
+        {
+            Dst dst{};
+            assign_fields(dst, std::forward<Src>(src), std::forward<Conv>(conv));
+            return dst;
+        }
+
+        template<typename Dst, typename Src>
+        Dst map_fields(Src &&src)
+        {
+            Dst dst{};
+            assign_fields(dst, std::forward<Src>(src), default_conversion());
+            return dst;
+        }
+    } // End of namespace cxl::reflection
+    using reflection::default_conversion;
+    using reflection::assign_fields;
+    using reflection::map_fields;
+    using reflection::mapped_count;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_MAP_FIELDS_HPP
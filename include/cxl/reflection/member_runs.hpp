@@ -0,0 +1,70 @@
+#ifndef CXL_REFLECTION_MEMBER_RUNS_HPP
+#define CXL_REFLECTION_MEMBER_RUNS_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <cxl/reflection/reflection_impl.hpp>
+
+// Runs of adjacent members handled as a single block of bytes, shared by hash.hpp and binary.hpp
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // True if the I-th element of T has an offset and Raw<element type> holds for it
+            template<template<typename> class Raw, std::size_t I, typename T, typename = void>
+            struct is_raw_member : bool_t<false>
+            {
+            };
+
+            template<template<typename> class Raw, std::size_t I, typename T>
+            struct is_raw_member<Raw, I, T, std::enable_if_t<(I < tuple_size<T>::value)>>
+                    : bool_t<element_has_offset<I, T> && Raw<reflected_element_type<I, T>>::value>
+            {
+            };
+
+            // True if the (I+1)-th member immediately follows the I-th one, with no padding in between
+            template<template<typename> class Raw,
+                     std::size_t I,
+                     typename T,
+                     bool = is_raw_member<Raw, I, T>::value && is_raw_member<Raw, I + 1, T>::value>
+            struct raw_joins_next : bool_t<false>
+            {
+            };
+
+            template<template<typename> class Raw, std::size_t I, typename T>
+            struct raw_joins_next<Raw, I, T, true>
+                    : bool_t<get_element_offset<I, T>() + sizeof(reflected_element_type<I, T>)
+                             == get_element_offset<I + 1, T>()>
+            {
+            };
+
+            // Byte offset of the end of the run of adjacent raw members containing the I-th one
+            template<template<typename> class Raw,
+                     std::size_t I,
+                     typename T,
+                     bool = raw_joins_next<Raw, I, T>::value>
+            struct raw_run_end : uint_t<get_element_offset<I, T>() + sizeof(reflected_element_type<I, T>)>
+            {
+            };
+
+            template<template<typename> class Raw, std::size_t I, typename T>
+            struct raw_run_end<Raw, I, T, true> : raw_run_end<Raw, I + 1, T>
+            {
+            };
+
+            typedef std::integral_constant<int, 0> by_value;
+            typedef std::integral_constant<int, 1> run_start;
+            typedef std::integral_constant<int, 2> in_run;
+
+            // A member is handled by value, as the start of a run, or not at all because it's covered
+            // by the run of a preceding member
+            template<template<typename> class Raw, std::size_t I, typename T>
+            using raw_member_kind = std::integral_constant<int, !is_raw_member<Raw, I, T>::value
+                                                                ? by_value::value
+                                                                : !raw_joins_next<Raw, I - 1, T>::value
+                                                                  ? run_start::value
+                                                                  : in_run::value>;
+        } // End of namespace cxl::reflection::detail
+    } // End of namespace cxl::reflection
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_MEMBER_RUNS_HPP
@@ -0,0 +1,956 @@
+#ifndef CXL_REFLECTION_MSGPACK_HPP
+#define CXL_REFLECTION_MSGPACK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/key_index.hpp>
+#include <cxl/reflection/value_kind.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace msgpack {
+            // How reflected objects are written: maps keyed by key(), or arrays of their elements in order
+            enum class layout
+            {
+                map, array
+            };
+
+            namespace detail {
+                using reflection::detail::unsupported_kind;
+                using reflection::detail::null_kind;
+                using reflection::detail::bool_kind;
+                using reflection::detail::integer_kind;
+                using reflection::detail::enum_kind;
+                using reflection::detail::float_kind;
+                using reflection::detail::string_kind;
+                using reflection::detail::variant_kind;
+                using reflection::detail::tuple_kind;
+                using reflection::detail::object_kind;
+                using reflection::detail::map_kind;
+                using reflection::detail::range_kind;
+                using reflection::detail::value_kind;
+                using reflection::detail::parsed_type;
+                using reflection::detail::key_length;
+
+                /**
+                 * Writes values as MessagePack, integers in the smallest format that holds them, floats
+                 * and doubles as float 32 and float 64, containers as arrays and string keyed maps as
+                 * maps. Lengths over 32 bits throw std::invalid_argument.
+                 */
+                class packer
+                {
+                public:
+                    packer(std::string &out, layout l) : out_(out), size_(out.size()), layout_(l) { }
+
+                    packer(const packer &) = delete;
+
+                    packer &operator=(const packer &) = delete;
+
+                    // Drops the room reserved past what was written
+                    ~packer()
+                    {
+                        out_.resize(size_);
+                    }
+
+                    template<typename T>
+                    void pack(const T &t)
+                    {
+                        static_assert(value_kind<uncv<T>>::value != unsupported_kind::value
+                                      && !std::is_pointer<T>::value, "Type cannot be written as MessagePack");
+                        pack_value(t, value_kind<uncv<T>>());
+                    }
+
+                private:
+                    // Room for `n` more bytes: the string grows geometrically, so most values are written
+                    // with no reallocation and no size update of the string
+                    char *room(std::size_t n)
+                    {
+                        if (out_.size() - size_ < n) {
+                            out_.resize(std::max(2 * out_.size(), size_ + n) + 64);
+                        }
+                        return &out_[size_];
+                    }
+
+                    void put(char c)
+                    {
+                        *room(1) = c;
+                        size_++;
+                    }
+
+                    // `tag`, then the low `n` bytes of `v`, big-endian
+                    void put(unsigned char tag, std::uint64_t v, std::size_t n)
+                    {
+                        char *q = room(n + 1);
+                        q[0] = char(tag);
+                        for (std::size_t i = 0; i < n; i++) {
+                            q[1 + i] = char(v >> (8 * (n - 1 - i)));
+                        }
+                        size_ += n + 1;
+                    }
+
+                    void append(const char *s, std::size_t n)
+                    {
+                        if (n > 0) {
+                            std::memcpy(room(n), s, n);
+                            size_ += n;
+                        }
+                    }
+
+                    void pack_unsigned(std::uint64_t v)
+                    {
+                        if (v < 0x80) {
+                            put(char(v));
+                        } else if (v <= 0xff) {
+                            put(0xcc, v, 1);
+                        } else if (v <= 0xffff) {
+                            put(0xcd, v, 2);
+                        } else if (v <= 0xffffffff) {
+                            put(0xce, v, 4);
+                        } else {
+                            put(0xcf, v, 8);
+                        }
+                    }
+
+                    // Positive values use the unsigned formats, as other implementations do
+                    void pack_signed(std::int64_t v)
+                    {
+                        if (v >= 0) {
+                            pack_unsigned(std::uint64_t(v));
+                        } else if (v >= -32) {
+                            put(char(v));
+                        } else if (v >= -128) {
+                            put(0xd0, std::uint64_t(v), 1);
+                        } else if (v >= -32768) {
+                            put(0xd1, std::uint64_t(v), 2);
+                        } else if (v >= std::numeric_limits<std::int32_t>::min()) {
+                            put(0xd2, std::uint64_t(v), 4);
+                        } else {
+                            put(0xd3, std::uint64_t(v), 8);
+                        }
+                    }
+
+                    // The header of a string, array or map of `n` items: a fix format if `n` fits in
+                    // `fix_bits`, else the 8 (strings only), 16 or 32 bit one
+                    void header(std::size_t n, unsigned char fix, std::size_t fix_bits, unsigned char tag8,
+                                unsigned char tag16)
+                    {
+                        if (n < (std::size_t(1) << fix_bits)) {
+                            put(char(fix | n));
+                        } else if (tag8 != 0 && n <= 0xff) {
+                            put(tag8, n, 1);
+                        } else if (n <= 0xffff) {
+                            put(tag16, n, 2);
+                        } else if (std::uint64_t(n) <= 0xffffffff) {
+                            put(tag16 + 1, n, 4);
+                        } else {
+                            throw std::invalid_argument("msgpack: more than 2^32 - 1 items");
+                        }
+                    }
+
+                    void pack_string(const char *s, std::size_t n)
+                    {
+                        header(n, 0xa0, 5, 0xd9, 0xda);
+                        append(s, n);
+                    }
+
+                    void pack_array(std::size_t n)
+                    {
+                        header(n, 0x90, 4, 0, 0xdc);
+                    }
+
+                    void pack_map(std::size_t n)
+                    {
+                        header(n, 0x80, 4, 0, 0xde);
+                    }
+
+                    void pack_value(std::nullptr_t, null_kind)
+                    {
+                        put(char(0xc0));
+                    }
+
+                    void pack_value(bool t, bool_kind)
+                    {
+                        put(char(t ? 0xc3 : 0xc2));
+                    }
+
+                    template<typename T>
+                    void pack_value(T t, integer_kind)
+                    {
+                        pack_integer(t, std::is_signed<T>());
+                    }
+
+                    template<typename T>
+                    void pack_integer(T t, std::true_type)
+                    {
+                        pack_signed(t);
+                    }
+
+                    template<typename T>
+                    void pack_integer(T t, std::false_type)
+                    {
+                        pack_unsigned(t);
+                    }
+
+                    template<typename T>
+                    void pack_value(T t, enum_kind)
+                    {
+                        pack_value(static_cast<std::underlying_type_t<T>>(t), integer_kind());
+                    }
+
+                    void pack_value(float t, float_kind)
+                    {
+                        std::uint32_t bits;
+                        std::memcpy(&bits, &t, sizeof(bits));
+                        put(0xca, bits, 4);
+                    }
+
+                    // double and long double, which has no MessagePack format
+                    template<typename T>
+                    void pack_value(T t, float_kind)
+                    {
+                        double d = double(t);
+                        std::uint64_t bits;
+                        std::memcpy(&bits, &d, sizeof(bits));
+                        put(0xcb, bits, 8);
+                    }
+
+                    template<typename T>
+                    void pack_value(const T &t, string_kind)
+                    {
+                        pack_string(t.data(), t.size());
+                    }
+
+                    struct variant_packer
+                    {
+                        template<typename U>
+                        void operator()(const U &u) const
+                        {
+                            p.pack(u);
+                        }
+
+                        packer &p;
+                    };
+
+                    // The current alternative, untagged, an empty variant is nil
+                    template<typename... U>
+                    void pack_value(const cxl::variant<U...> &t, variant_kind)
+                    {
+                        if (t.which() >= sizeof...(U)) {
+                            put(char(0xc0));
+                        } else {
+                            t.apply_visitor(variant_packer{*this});
+                        }
+                    }
+
+                    template<typename T, std::size_t... I>
+                    void pack_elements(const T &t, std::index_sequence<I...>)
+                    {
+                        pack_array(sizeof...(I));
+                        typedef int expander[];
+                        (void) expander{0, (pack(reflected_element<I, T>::get(t)), 0)...};
+                    }
+
+                    template<std::size_t I, typename T>
+                    void pack_member(const T &t)
+                    {
+                        constexpr const char *key = reflected_element<I, T>::key();
+                        pack_string(key, std::integral_constant<std::size_t, key_length(key)>::value);
+                        pack(reflected_element<I, T>::get(t));
+                    }
+
+                    template<typename T, std::size_t... I>
+                    void pack_members(const T &t, std::index_sequence<I...>)
+                    {
+                        pack_map(sizeof...(I));
+                        typedef int expander[];
+                        (void) expander{0, (pack_member<I>(t), 0)...};
+                    }
+
+                    template<typename T>
+                    void pack_value(const T &t, tuple_kind)
+                    {
+                        pack_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+                    }
+
+                    template<typename T>
+                    void pack_value(const T &t, object_kind)
+                    {
+                        if (layout_ == layout::array) {
+                            pack_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+                        } else {
+                            pack_members(t, std::make_index_sequence<tuple_size<T>::value>());
+                        }
+                    }
+
+                    template<typename T>
+                    void pack_value(const T &t, map_kind)
+                    {
+                        pack_map(t.size());
+                        for (const auto &e : t) {
+                            pack_string(e.first.data(), e.first.size());
+                            pack(e.second);
+                        }
+                    }
+
+                    template<typename T>
+                    void pack_value(const T &t, range_kind)
+                    {
+                        pack_array(std::size_t(std::distance(std::begin(t), std::end(t))));
+                        for (const auto &e : t) {
+                            pack(e);
+                        }
+                    }
+
+                    std::string &out_;
+                    std::size_t size_;
+                    layout layout_;
+                };
+
+                // The keys of T, for key_index
+                template<typename T>
+                struct msgpack_keys
+                {
+                    static constexpr std::size_t size = tuple_size<T>::value;
+
+                    static constexpr const char *key(std::size_t i)
+                    {
+                        return get_element_descriptors<T>()[i].key;
+                    }
+
+                    static constexpr std::size_t length(std::size_t i) { return key_length(key(i)); }
+                };
+
+                // Perfect hash of the keys of T
+                template<typename T>
+                using key_index = reflection::detail::key_index<msgpack_keys<T>>;
+
+                class unpacker;
+
+                struct element_reader;
+
+                // Element unpackers by element index
+                template<typename T>
+                using element_unpackers = reflection::detail::element_reader_table<element_reader, T>;
+
+                /**
+                 * Reads MessagePack from memory straight into the target values. Malformed input, types
+                 * that don't match the target and integers out of its range throw std::invalid_argument.
+                 */
+                class unpacker
+                {
+                public:
+                    unpacker(const char *begin, const char *end) : begin_(begin), p_(begin), end_(end) { }
+
+                    template<typename T>
+                    void unpack(T &t)
+                    {
+                        static_assert(value_kind<T>::value != unsupported_kind::value
+                                      && !std::is_pointer<T>::value, "Type cannot be read from MessagePack");
+                        unpack_value(t, value_kind<T>());
+                    }
+
+                    // Skips one value of any type, nested ones included, without recursion
+                    void skip_value()
+                    {
+                        for (std::uint64_t n = 1; n > 0; n--) {
+                            unsigned char c = byte();
+                            if (c < 0x80 || c >= 0xe0 || c == 0xc0 || c == 0xc2 || c == 0xc3) {
+                                continue;
+                            }
+                            if (c < 0x90) {
+                                n += 2 * std::uint64_t(c & 0x0f);
+                            } else if (c < 0xa0) {
+                                n += c & 0x0f;
+                            } else if (c < 0xc0) {
+                                advance(c & 0x1f);
+                            } else {
+                                skip_rest(c, n);
+                            }
+                        }
+                    }
+
+                    void finish()
+                    {
+                        if (p_ != end_) {
+                            fail("unexpected bytes after the value");
+                        }
+                    }
+
+                    [[noreturn]] void fail(const char *what) const
+                    {
+                        throw std::invalid_argument(std::string("msgpack: ") + what + " at offset "
+                                                    + std::to_string(p_ - begin_));
+                    }
+
+                private:
+                    unsigned char peek()
+                    {
+                        if (p_ == end_) {
+                            fail("truncated input");
+                        }
+                        return static_cast<unsigned char>(*p_);
+                    }
+
+                    unsigned char byte()
+                    {
+                        unsigned char c = peek();
+                        ++p_;
+                        return c;
+                    }
+
+                    void advance(std::uint64_t n)
+                    {
+                        if (n > std::uint64_t(end_ - p_)) {
+                            fail("truncated input");
+                        }
+                        p_ += n;
+                    }
+
+                    // The next `n` bytes as a big-endian unsigned number
+                    std::uint64_t be(std::size_t n)
+                    {
+                        if (n > std::size_t(end_ - p_)) {
+                            fail("truncated input");
+                        }
+                        std::uint64_t v = 0;
+                        for (std::size_t i = 0; i < n; i++) {
+                            v = (v << 8) | static_cast<unsigned char>(p_[i]);
+                        }
+                        p_ += n;
+                        return v;
+                    }
+
+                    // The formats with a type byte of 0xc0 or more, adding the items of containers to `n`
+                    void skip_rest(unsigned char c, std::uint64_t &n)
+                    {
+                        // Sizes of the fixed size formats from 0xc0, 0 for the others
+                        static constexpr unsigned char sizes[32] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                                                    0, 0, 4, 8, 1, 2, 4, 8,
+                                                                    1, 2, 4, 8, 2, 3, 5, 9,
+                                                                    17, 0, 0, 0, 0, 0, 0, 0};
+                        switch (c) {
+                            case 0xc4:
+                            case 0xd9:
+                                advance(be(1));
+                                break;
+                            case 0xc5:
+                            case 0xda:
+                                advance(be(2));
+                                break;
+                            case 0xc6:
+                            case 0xdb:
+                                advance(be(4));
+                                break;
+                            case 0xc7:
+                                advance(be(1) + 1);
+                                break;
+                            case 0xc8:
+                                advance(be(2) + 1);
+                                break;
+                            case 0xc9:
+                                advance(be(4) + 1);
+                                break;
+                            case 0xdc:
+                                n += be(2);
+                                break;
+                            case 0xdd:
+                                n += be(4);
+                                break;
+                            case 0xde:
+                                n += 2 * be(2);
+                                break;
+                            case 0xdf:
+                                n += 2 * be(4);
+                                break;
+                            default:
+                                if (sizes[c - 0xc0] == 0) {
+                                    --p_;
+                                    fail("invalid type");
+                                }
+                                advance(sizes[c - 0xc0]);
+                        }
+                    }
+
+                    // Strings and binaries, which are read into strings too
+                    static bool is_string(unsigned char c)
+                    {
+                        return (c >= 0xa0 && c < 0xc0) || (c >= 0xd9 && c <= 0xdb)
+                               || (c >= 0xc4 && c <= 0xc6);
+                    }
+
+                    // The string or binary at p_, which stays in the input
+                    void read_string(const char *&s, std::size_t &n)
+                    {
+                        unsigned char c = peek();
+                        if (!is_string(c)) {
+                            fail("expected a string");
+                        }
+                        ++p_;
+                        if (c < 0xc0) {
+                            n = c & 0x1f;
+                        } else {
+                            // str 8/16/32 and bin 8/16/32
+                            n = std::size_t(be(std::size_t(1) << (c >= 0xd9 ? c - 0xd9 : c - 0xc4)));
+                        }
+                        s = p_;
+                        advance(n);
+                    }
+
+                    // The size of the array or map at p_, or false if it's something else
+                    bool container_size(std::size_t &n, unsigned char fix, unsigned char tag16)
+                    {
+                        unsigned char c = peek();
+                        if ((c & 0xf0) == fix) {
+                            ++p_;
+                            n = c & 0x0f;
+                        } else if (c == tag16) {
+                            ++p_;
+                            n = be(2);
+                        } else if (c == tag16 + 1) {
+                            ++p_;
+                            n = be(4);
+                        } else {
+                            return false;
+                        }
+                        // Every item takes a byte at least
+                        if (n > std::size_t(end_ - p_)) {
+                            fail("truncated input");
+                        }
+                        return true;
+                    }
+
+                    std::size_t array_size()
+                    {
+                        std::size_t n;
+                        if (!container_size(n, 0x90, 0xdc)) {
+                            fail("expected an array");
+                        }
+                        return n;
+                    }
+
+                    std::size_t map_size()
+                    {
+                        std::size_t n;
+                        if (!container_size(n, 0x80, 0xde)) {
+                            fail("expected a map");
+                        }
+                        return n;
+                    }
+
+                    static bool is_integer(unsigned char c)
+                    {
+                        return c < 0x80 || c >= 0xe0 || (c >= 0xcc && c <= 0xd3);
+                    }
+
+                    static bool is_array(unsigned char c)
+                    {
+                        return (c & 0xf0) == 0x90 || c == 0xdc || c == 0xdd;
+                    }
+
+                    static bool is_map(unsigned char c)
+                    {
+                        return (c & 0xf0) == 0x80 || c == 0xde || c == 0xdf;
+                    }
+
+                    // The integer at p_ as 64 bits, `negative` if it's a signed format holding a negative
+                    // value
+                    std::uint64_t integer(bool &negative)
+                    {
+                        unsigned char c = byte();
+                        negative = false;
+                        if (c < 0x80) {
+                            return c;
+                        }
+                        if (c >= 0xe0) {
+                            negative = true;
+                            return std::uint64_t(std::int64_t(std::int8_t(c)));
+                        }
+                        std::int64_t v;
+                        switch (c) {
+                            case 0xcc:
+                                return be(1);
+                            case 0xcd:
+                                return be(2);
+                            case 0xce:
+                                return be(4);
+                            case 0xcf:
+                                return be(8);
+                            case 0xd0:
+                                v = std::int8_t(be(1));
+                                break;
+                            case 0xd1:
+                                v = std::int16_t(be(2));
+                                break;
+                            case 0xd2:
+                                v = std::int32_t(be(4));
+                                break;
+                            case 0xd3:
+                                v = std::int64_t(be(8));
+                                break;
+                            default:
+                                --p_;
+                                fail("expected an integer");
+                        }
+                        negative = v < 0;
+                        return std::uint64_t(v);
+                    }
+
+                    template<typename T>
+                    static bool fits(std::uint64_t v, bool negative)
+                    {
+                        if (negative) {
+                            return std::is_signed<T>::value
+                                   && std::int64_t(v) >= std::int64_t(std::numeric_limits<T>::min());
+                        }
+                        return v <= std::uint64_t(std::numeric_limits<T>::max());
+                    }
+
+                    void unpack_value(std::nullptr_t &, null_kind)
+                    {
+                        if (peek() != 0xc0) {
+                            fail("expected nil");
+                        }
+                        ++p_;
+                    }
+
+                    void unpack_value(bool &t, bool_kind)
+                    {
+                        unsigned char c = peek();
+                        if (c != 0xc2 && c != 0xc3) {
+                            fail("expected a boolean");
+                        }
+                        ++p_;
+                        t = c == 0xc3;
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, integer_kind)
+                    {
+                        const char *start = p_;
+                        bool negative;
+                        std::uint64_t v = integer(negative);
+                        if (!fits<T>(v, negative)) {
+                            p_ = start;
+                            fail("integer out of range");
+                        }
+                        t = static_cast<T>(v);
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, enum_kind)
+                    {
+                        std::underlying_type_t<T> v;
+                        unpack_value(v, integer_kind());
+                        t = static_cast<T>(v);
+                    }
+
+                    // Either float format, or an integer
+                    template<typename T>
+                    void unpack_value(T &t, float_kind)
+                    {
+                        unsigned char c = peek();
+                        if (c == 0xca) {
+                            ++p_;
+                            std::uint32_t bits = std::uint32_t(be(4));
+                            float f;
+                            std::memcpy(&f, &bits, sizeof(f));
+                            t = T(f);
+                        } else if (c == 0xcb) {
+                            ++p_;
+                            std::uint64_t bits = be(8);
+                            double d;
+                            std::memcpy(&d, &bits, sizeof(d));
+                            t = T(d);
+                        } else if (is_integer(c)) {
+                            bool negative;
+                            std::uint64_t v = integer(negative);
+                            t = negative ? T(std::int64_t(v)) : T(v);
+                        } else {
+                            fail("expected a number");
+                        }
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, string_kind)
+                    {
+                        const char *s;
+                        std::size_t n;
+                        read_string(s, n);
+                        t.assign(s, n);
+                    }
+
+                    // Whether the value at p_ can be read as a U, integers must also be in its range
+                    template<typename U>
+                    bool accepts(null_kind)
+                    {
+                        return peek() == 0xc0;
+                    }
+
+                    template<typename U>
+                    bool accepts(bool_kind)
+                    {
+                        return peek() == 0xc2 || peek() == 0xc3;
+                    }
+
+                    template<typename U>
+                    bool accepts(integer_kind)
+                    {
+                        if (!is_integer(peek())) {
+                            return false;
+                        }
+                        const char *start = p_;
+                        bool negative;
+                        std::uint64_t v = integer(negative);
+                        p_ = start;
+                        return fits<U>(v, negative);
+                    }
+
+                    template<typename U>
+                    bool accepts(enum_kind)
+                    {
+                        return accepts<std::underlying_type_t<U>>(integer_kind());
+                    }
+
+                    template<typename U>
+                    bool accepts(float_kind)
+                    {
+                        return peek() == 0xca || peek() == 0xcb || is_integer(peek());
+                    }
+
+                    template<typename U>
+                    bool accepts(string_kind)
+                    {
+                        return is_string(peek());
+                    }
+
+                    template<typename U>
+                    bool accepts(variant_kind)
+                    {
+                        return accepts_any(static_cast<U *>(nullptr));
+                    }
+
+                    template<typename... V>
+                    bool accepts_any(cxl::variant<V...> *)
+                    {
+                        bool any = false;
+                        typedef int expander[];
+                        (void) expander{0, (any = any || accepts<uncv<unwrap_type<V>>>(
+                                value_kind<uncv<unwrap_type<V>>>()), 0)...};
+                        return any;
+                    }
+
+                    template<typename U>
+                    bool accepts(tuple_kind)
+                    {
+                        return is_array(peek());
+                    }
+
+                    template<typename U>
+                    bool accepts(object_kind)
+                    {
+                        return is_array(peek()) || is_map(peek());
+                    }
+
+                    template<typename U>
+                    bool accepts(map_kind)
+                    {
+                        return is_map(peek());
+                    }
+
+                    template<typename U>
+                    bool accepts(range_kind)
+                    {
+                        return is_array(peek());
+                    }
+
+                    template<typename U, typename V>
+                    bool unpack_alternative(V &v)
+                    {
+                        typedef uncv<unwrap_type<U>> A;
+                        if (!accepts<A>(value_kind<A>())) {
+                            return false;
+                        }
+                        A a{};
+                        unpack(a);
+                        v = std::move(a);
+                        return true;
+                    }
+
+                    // The first alternative that accepts the value is kept
+                    template<typename... U>
+                    void unpack_value(cxl::variant<U...> &t, variant_kind)
+                    {
+                        bool done = false;
+                        typedef int expander[];
+                        (void) expander{0, (done = done || unpack_alternative<U>(t), 0)...};
+                        if (!done) {
+                            fail("no alternative of the variant matches");
+                        }
+                    }
+
+                    template<typename T, std::size_t... I>
+                    void unpack_elements(T &t, std::index_sequence<I...>)
+                    {
+                        typedef int expander[];
+                        (void) expander{0, (unpack(reflected_element<I, T>::get(t)), 0)...};
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, tuple_kind)
+                    {
+                        if (array_size() != tuple_size<T>::value) {
+                            fail("unexpected number of elements");
+                        }
+                        unpack_elements(t, std::make_index_sequence<tuple_size<T>::value>());
+                    }
+
+                    /*
+                     * Maps are matched by key through the perfect hash of T's keys, unknown keys are
+                     * skipped. Arrays are read in element order, extra items are skipped. Elements
+                     * missing from either are left untouched.
+                     */
+                    template<typename T>
+                    void unpack_value(T &t, object_kind)
+                    {
+                        constexpr std::size_t size = tuple_size<T>::value;
+                        std::size_t n;
+                        if (container_size(n, 0x90, 0xdc)) {
+                            for (std::size_t i = 0; i < n; i++) {
+                                if (i < size) {
+                                    element_unpackers<T>::readers[i](*this, t);
+                                } else {
+                                    skip_value();
+                                }
+                            }
+                            return;
+                        }
+                        for (n = map_size(); n > 0; n--) {
+                            const char *key;
+                            std::size_t length;
+                            read_string(key, length);
+                            std::size_t i = key_index<T>::find(key, length);
+                            if (i < size) {
+                                element_unpackers<T>::readers[i](*this, t);
+                            } else {
+                                skip_value();
+                            }
+                        }
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, map_kind)
+                    {
+                        t.clear();
+                        for (std::size_t n = map_size(); n > 0; n--) {
+                            typename T::key_type key;
+                            unpack_value(key, string_kind());
+                            typename T::mapped_type value{};
+                            unpack(value);
+                            t.emplace(std::move(key), std::move(value));
+                        }
+                    }
+
+                    template<typename T>
+                    void unpack_value(T &t, range_kind)
+                    {
+                        t.clear();
+                        for (std::size_t n = array_size(); n > 0; n--) {
+                            typename parsed_type<typename T::value_type>::type value{};
+                            unpack(value);
+                            t.insert(t.end(), std::move(value));
+                        }
+                    }
+
+                    const char *begin_;
+                    const char *p_;
+                    const char *end_;
+                };
+
+                // Readonly elements are skipped, elements with a setter are read into a temporary
+                struct element_reader
+                {
+                    typedef unpacker input_type;
+
+                    template<typename U>
+                    static void read(unpacker &in, U &v)
+                    {
+                        in.unpack(v);
+                    }
+
+                    static void skip(unpacker &in) { in.skip_value(); }
+                };
+            }   // End of namespace detail
+
+            /**
+             * Appends the MessagePack encoding of `t` to `out`. Reflected objects are maps keyed by
+             * their key()s, or arrays of their elements with layout::array, tuples and containers are
+             * arrays, string keyed maps are maps, cxl::variant is its current alternative and an
+             * empty one nil. Integers take the smallest format that holds their value.
+             */
+            template<typename T>
+            void encode(std::string &out, const T &t, layout l = layout::map)
+            {
+                detail::packer p(out, l);
+                p.pack(t);
+            }
+
+            template<typename T>
+            std::string encode(const T &t, layout l = layout::map)
+            {
+                std::string ret;
+                encode(ret, t, l);
+                return ret;
+            }
+
+            /**
+             * Decodes MessagePack straight into `t`. Reflected objects are read from maps, keys are
+             * matched through a compile-time perfect hash of T's keys and unknown ones are skipped,
+             * or from arrays of their elements in order. Elements missing from the data are left
+             * untouched and containers are replaced. Integers of any format are accepted by integer
+             * and floating point targets if they fit. A variant takes the first alternative that
+             * accepts the type of the value. Malformed input or values that don't fit their target
+             * throw std::invalid_argument.
+             */
+            template<typename T>
+            void decode(const char *data, std::size_t size, T &t)
+            {
+                detail::unpacker in(data, data + size);
+                in.unpack(t);
+                in.finish();
+            }
+
+            template<typename T>
+            void decode(const std::string &data, T &t)
+            {
+                decode(data.data(), data.size(), t);
+            }
+
+            template<typename T>
+            T decode(const char *data, std::size_t size)
+            {
+                T t{};
+                decode(data, size, t);
+                return t;
+            }
+
+            template<typename T>
+            T decode(const std::string &data)
+            {
+                return decode<T>(data.data(), data.size());
+            }
+        }
+    }
+    namespace msgpack = reflection::msgpack;
+}
+
+#endif // CXL_REFLECTION_MSGPACK_HPP
@@ -0,0 +1,99 @@
+#ifndef CXL_REFLECTION_PARALLEL_HPP
+#define CXL_REFLECTION_PARALLEL_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <cxl/reflection/reflection_impl.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Visits elements [lo, hi) of t, the index check is resolved per unrolled call
+            template<typename T, typename V, std::size_t... I>
+            void enumerate_slice(T &t, V &v, std::size_t lo, std::size_t hi, std::index_sequence<I...>)
+            {
+                typedef int expander[];
+                (void) expander{0, ((I >= lo && I < hi)
+                                    ? (v(reflected_element<I, T>::get(t),
+                                         std::integral_constant<std::size_t, I>(),
+                                         reflected_element<I, T>()), 0)
+                                    : 0)...};
+            }
+
+            inline std::size_t default_concurrency()
+            {
+                std::size_t n = std::thread::hardware_concurrency();
+                return n == 0 ? 1 : n;
+            }
+        } // End of namespace detail
+
+        /**
+         * Field-wise for_each_element_indexed over a range of reflectable objects.
+         *
+         * Element indices are split into `concurrency` contiguous slices, each slice is visited for
+         * every object in the range by its own thread, so `v` is called concurrently for different
+         * elements but never for the same element. The first exception thrown by `v` is rethrown.
+         */
+        template<typename Range, typename V>
+        void parallel_for_each_element(Range &&range, V &&v, std::size_t concurrency = 0)
+        {
+            typedef unref<decltype(*std::begin(range))> value_type;
+            static_assert(reflectable<value_type>,
+                          "parallel_for_each_element only supports reflectable types.");
+            constexpr std::size_t count = tuple_size<value_type>::value;
+            typedef std::make_index_sequence<count> sequence;
+
+            if (concurrency == 0) {
+                concurrency = detail::default_concurrency();
+            }
+            concurrency = std::max<std::size_t>(1, std::min(concurrency, count));
+
+            std::vector<std::exception_ptr> errors(concurrency);
+            auto worker = [&](std::size_t slice) {
+                std::size_t lo = count * slice / concurrency;
+                std::size_t hi = count * (slice + 1) / concurrency;
+                try {
+                    for (auto &&t : range) {
+                        detail::enumerate_slice(t, v, lo, hi, sequence());
+                    }
+                } catch (...) {
+                    errors[slice] = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(concurrency - 1);
+            for (std::size_t slice = 1; slice < concurrency; slice++) {
+                threads.emplace_back(worker, slice);
+            }
+            worker(0);
+            for (std::thread &th : threads) {
+                th.join();
+            }
+            for (std::exception_ptr &e : errors) {
+                if (e) {
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+
+        /**
+         * for_each_element over a range of reflectable objects: parallel_for_each_element, `v` is
+         * called as by for_each_element_indexed, for different elements concurrently.
+         */
+        template<typename Range, typename V>
+        std::enable_if_t<detail::is_reflectable_range<unrefcv<Range>>::value>
+        for_each_element(Range &&range, V &&v, std::size_t concurrency = 0)
+        {
+            parallel_for_each_element(std::forward<Range>(range), std::forward<V>(v), concurrency);
+        }
+    } // End of namespace cxl::reflection
+    using reflection::parallel_for_each_element;
+    using reflection::for_each_element;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_PARALLEL_HPP
@@ -0,0 +1,557 @@
+#ifndef CXL_REFLECTION_PATCH_HPP
+#define CXL_REFLECTION_PATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <stdexcept>
+#include <typeinfo>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/hash.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Compact binary encoding of values: LEB128 varints for integers (zigzag for signed),
+            // raw little-endian bytes for floating point, length-prefixed strings, reflectable
+            // values as the sequence of their elements, vectors and maps as the element count followed
+            // by the elements, variants as the alternative index followed by the value. Other containers
+            // are not supported and fail to compile
+            inline void wire_write_varint(std::string &out, std::uint64_t v)
+            {
+                while (v >= 0x80) {
+                    out.push_back(char(v | 0x80));
+                    v >>= 7;
+                }
+                out.push_back(char(v));
+            }
+
+            inline bool wire_read_varint(const char *&p, const char *end, std::uint64_t &v)
+            {
+                v = 0;
+                for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+                    std::uint64_t b = static_cast<unsigned char>(*p++);
+                    v |= (b & 0x7f) << shift;
+                    if (b < 0x80) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            inline void wire_write(std::string &out, bool v)
+            {
+                out.push_back(v ? 1 : 0);
+            }
+
+            inline bool wire_read(const char *&p, const char *end, bool &v)
+            {
+                if (p == end || static_cast<unsigned char>(*p) > 1) {
+                    return false;
+                }
+                v = *p++ != 0;
+                return true;
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_integral<U>::value && std::is_unsigned<U>::value
+                             && !std::is_same<U, bool>::value>
+            wire_write(std::string &out, U v)
+            {
+                wire_write_varint(out, v);
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_integral<U>::value && std::is_unsigned<U>::value
+                             && !std::is_same<U, bool>::value, bool>
+            wire_read(const char *&p, const char *end, U &v)
+            {
+                std::uint64_t x;
+                if (!wire_read_varint(p, end, x) || x > std::uint64_t(U(-1))) {
+                    return false;
+                }
+                v = U(x);
+                return true;
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_integral<U>::value && std::is_signed<U>::value>
+            wire_write(std::string &out, U v)
+            {
+                std::uint64_t x = std::uint64_t(std::int64_t(v));
+                wire_write_varint(out, (x << 1) ^ (std::int64_t(v) < 0 ? ~std::uint64_t(0) : 0));
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_integral<U>::value && std::is_signed<U>::value, bool>
+            wire_read(const char *&p, const char *end, U &v)
+            {
+                std::uint64_t x;
+                if (!wire_read_varint(p, end, x)) {
+                    return false;
+                }
+                std::int64_t s = std::int64_t(x >> 1) ^ -std::int64_t(x & 1);
+                if (s < std::int64_t(std::numeric_limits<U>::min())
+                    || s > std::int64_t(std::numeric_limits<U>::max())) {
+                    return false;
+                }
+                v = U(s);
+                return true;
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_enum<U>::value> wire_write(std::string &out, U v)
+            {
+                wire_write(out, static_cast<std::underlying_type_t<U>>(v));
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_enum<U>::value, bool> wire_read(const char *&p, const char *end, U &v)
+            {
+                std::underlying_type_t<U> x;
+                if (!wire_read(p, end, x)) {
+                    return false;
+                }
+                v = static_cast<U>(x);
+                return true;
+            }
+
+            // Floating point values are stored as in memory, only little-endian hosts are supported
+#ifdef __BYTE_ORDER__
+            static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "patch: little-endian hosts only");
+#endif
+
+            template<typename U>
+            std::enable_if_t<std::is_floating_point<U>::value> wire_write(std::string &out, U v)
+            {
+                out.append(reinterpret_cast<const char *>(&v), sizeof(U));
+            }
+
+            template<typename U>
+            std::enable_if_t<std::is_floating_point<U>::value, bool>
+            wire_read(const char *&p, const char *end, U &v)
+            {
+                if (std::size_t(end - p) < sizeof(U)) {
+                    return false;
+                }
+                std::memcpy(&v, p, sizeof(U));
+                p += sizeof(U);
+                return true;
+            }
+
+            inline void wire_write(std::string &out, const std::string &v)
+            {
+                wire_write_varint(out, v.size());
+                out.append(v);
+            }
+
+            inline bool wire_read(const char *&p, const char *end, std::string &v)
+            {
+                std::uint64_t n;
+                if (!wire_read_varint(p, end, n) || n > std::uint64_t(end - p)) {
+                    return false;
+                }
+                v.assign(p, std::size_t(n));
+                p += n;
+                return true;
+            }
+
+            template<typename T>
+            std::enable_if_t<reflectable<T>> wire_write(std::string &out, const T &t);
+
+            template<typename T>
+            std::enable_if_t<reflectable<T>, bool> wire_read(const char *&p, const char *end, T &t);
+
+            template<typename U, typename A>
+            void wire_write(std::string &out, const std::vector<U, A> &v);
+
+            template<typename U, typename A>
+            bool wire_read(const char *&p, const char *end, std::vector<U, A> &v);
+
+            template<typename K, typename V, typename C, typename A>
+            void wire_write(std::string &out, const std::map<K, V, C, A> &m);
+
+            template<typename K, typename V, typename C, typename A>
+            bool wire_read(const char *&p, const char *end, std::map<K, V, C, A> &m);
+
+            template<typename... U>
+            void wire_write(std::string &out, const cxl::variant<U...> &v);
+
+            template<typename... U>
+            bool wire_read(const char *&p, const char *end, cxl::variant<U...> &v);
+
+            template<typename T, std::size_t... I>
+            void wire_write_elements(std::string &out, const T &t, std::index_sequence<I...>)
+            {
+                typedef int expander[];
+                (void) expander{0, (wire_write(out, reflected_element<I, T>::get(t)), 0)...};
+            }
+
+            template<typename T>
+            std::enable_if_t<reflectable<T>> wire_write(std::string &out, const T &t)
+            {
+                wire_write_elements(out, t, std::make_index_sequence<tuple_size<T>::value>());
+            }
+
+            // Readonly elements are part of the encoding, they are read and dropped
+            template<std::size_t I, typename T>
+            std::enable_if_t<!std::is_const<reflected_element_type<I, T>>::value, bool>
+            wire_read_element(const char *&p, const char *end, T &t)
+            {
+                unrefcv<reflected_element_type<I, T>> v;
+                if (!wire_read(p, end, v)) {
+                    return false;
+                }
+                reflected_element<I, T>::set(t, std::move(v));
+                return true;
+            }
+
+            template<std::size_t I, typename T>
+            std::enable_if_t<std::is_const<reflected_element_type<I, T>>::value, bool>
+            wire_read_element(const char *&p, const char *end, T &)
+            {
+                unrefcv<reflected_element_type<I, T>> v;
+                return wire_read(p, end, v);
+            }
+
+            template<typename T, std::size_t... I>
+            bool wire_read_elements(const char *&p, const char *end, T &t, std::index_sequence<I...>)
+            {
+                bool r = true;
+                typedef int expander[];
+                (void) expander{0, (r = r && wire_read_element<I>(p, end, t), 0)...};
+                return r;
+            }
+
+            template<typename T>
+            std::enable_if_t<reflectable<T>, bool> wire_read(const char *&p, const char *end, T &t)
+            {
+                return wire_read_elements(p, end, t, std::make_index_sequence<tuple_size<T>::value>());
+            }
+
+            template<typename U, typename A>
+            void wire_write(std::string &out, const std::vector<U, A> &v)
+            {
+                wire_write_varint(out, v.size());
+                for (const auto &e : v) {
+                    wire_write(out, static_cast<const U &>(e));
+                }
+            }
+
+            template<typename U, typename A>
+            bool wire_read(const char *&p, const char *end, std::vector<U, A> &v)
+            {
+                std::uint64_t n;
+                // Every element takes at least one byte, which bounds the count
+                if (!wire_read_varint(p, end, n) || n > std::uint64_t(end - p)) {
+                    return false;
+                }
+                v.clear();
+                v.reserve(std::size_t(n));
+                for (; n > 0; n--) {
+                    U e{};
+                    if (!wire_read(p, end, e)) {
+                        return false;
+                    }
+                    v.push_back(std::move(e));
+                }
+                return true;
+            }
+
+            template<typename K, typename V, typename C, typename A>
+            void wire_write(std::string &out, const std::map<K, V, C, A> &m)
+            {
+                wire_write_varint(out, m.size());
+                for (const auto &e : m) {
+                    wire_write(out, e.first);
+                    wire_write(out, e.second);
+                }
+            }
+
+            template<typename K, typename V, typename C, typename A>
+            bool wire_read(const char *&p, const char *end, std::map<K, V, C, A> &m)
+            {
+                std::uint64_t n;
+                if (!wire_read_varint(p, end, n) || n > std::uint64_t(end - p)) {
+                    return false;
+                }
+                m.clear();
+                for (; n > 0; n--) {
+                    K key{};
+                    V value{};
+                    if (!wire_read(p, end, key) || !wire_read(p, end, value)) {
+                        return false;
+                    }
+                    m.emplace(std::move(key), std::move(value));
+                }
+                return true;
+            }
+
+            struct wire_variant_writer
+            {
+                template<typename U>
+                void operator()(const U &u) const
+                {
+                    wire_write(out, u);
+                }
+
+                std::string &out;
+            };
+
+            template<typename U, typename V>
+            bool wire_read_alternative(const char *&p, const char *end, V &v)
+            {
+                unwrap_type<U> a{};
+                if (!wire_read(p, end, a)) {
+                    return false;
+                }
+                v = std::move(a);
+                return true;
+            }
+
+            template<typename... U>
+            void wire_write(std::string &out, const cxl::variant<U...> &v)
+            {
+                if (v.which() >= sizeof...(U)) {
+                    throw std::invalid_argument("patch: cannot encode an empty variant");
+                }
+                wire_write_varint(out, v.which());
+                v.apply_visitor(wire_variant_writer{out});
+            }
+
+            template<typename... U>
+            bool wire_read(const char *&p, const char *end, cxl::variant<U...> &v)
+            {
+                std::uint64_t which;
+                if (!wire_read_varint(p, end, which) || which >= sizeof...(U)) {
+                    return false;
+                }
+                typedef bool (*reader_type)(const char *&, const char *, cxl::variant<U...> &);
+                static constexpr reader_type readers[] = {&wire_read_alternative<U, cxl::variant<U...>>...};
+                return readers[which](p, end, v);
+            }
+
+            template<std::size_t I, typename T>
+            using is_patchable = bool_t<!std::is_const<reflected_element_type<I, T>>::value>;
+
+            template<std::size_t I, typename T>
+            std::enable_if_t<is_patchable<I, T>::value, bool>
+            diff_element(std::string &out, const T &a, const T &b)
+            {
+                typedef reflected_element<I, T> element;
+                if (equal_of(element::get(a), element::get(b))) {
+                    return false;
+                }
+                wire_write_varint(out, I);
+                wire_write(out, element::get(b));
+                return true;
+            }
+
+            template<std::size_t I, typename T>
+            std::enable_if_t<!is_patchable<I, T>::value, bool>
+            diff_element(std::string &, const T &, const T &)
+            {
+                return false;
+            }
+
+            template<typename T, std::size_t... I>
+            std::size_t diff_elements(std::string &out, const T &a, const T &b, std::index_sequence<I...>)
+            {
+                std::size_t n = 0;
+                typedef int expander[];
+                (void) expander{0, (n += diff_element<I>(out, a, b) ? 1 : 0, 0)...};
+                return n;
+            }
+
+            // Reads the value of the I-th element, applies it to `t` if it's not null
+            template<std::size_t I, typename T>
+            std::enable_if_t<is_patchable<I, T>::value, bool>
+            patch_element(const char *&p, const char *end, T *t)
+            {
+                unrefcv<reflected_element_type<I, T>> v;
+                if (!wire_read(p, end, v)) {
+                    return false;
+                }
+                if (t != nullptr) {
+                    reflected_element<I, T>::set(*t, std::move(v));
+                }
+                return true;
+            }
+
+            // Readonly elements never appear in a patch, an encoded one is invalid
+            template<std::size_t I, typename T>
+            std::enable_if_t<!is_patchable<I, T>::value, bool> patch_element(const char *&, const char *, T *)
+            {
+                return false;
+            }
+
+            template<std::size_t I, typename T>
+            std::enable_if_t<is_patchable<I, T>::value> record_element(std::string &out, const T &t)
+            {
+                wire_write_varint(out, I);
+                wire_write(out, reflected_element<I, T>::get(t));
+            }
+
+            template<std::size_t I, typename T>
+            std::enable_if_t<!is_patchable<I, T>::value> record_element(std::string &, const T &)
+            {
+                throw std::bad_cast();
+            }
+
+            template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct patch_table;
+
+            template<typename T, std::size_t... I>
+            struct patch_table<T, std::index_sequence<I...>>
+            {
+                typedef bool (*applier_type)(const char *&, const char *, T *);
+                typedef void (*recorder_type)(std::string &, const T &);
+                // One extra entry, so that the tables of an empty T are not zero-sized
+                static constexpr applier_type appliers[sizeof...(I) + 1] = {&patch_element<I, T>..., nullptr};
+                static constexpr recorder_type recorders[sizeof...(I) + 1] = {&record_element<I, T>...,
+                                                                              nullptr};
+            };
+
+            template<typename T, std::size_t... I>
+            constexpr typename patch_table<T, std::index_sequence<I...>>::applier_type
+                    patch_table<T, std::index_sequence<I...>>::appliers[sizeof...(I) + 1];
+
+            template<typename T, std::size_t... I>
+            constexpr typename patch_table<T, std::index_sequence<I...>>::recorder_type
+                    patch_table<T, std::index_sequence<I...>>::recorders[sizeof...(I) + 1];
+        } // End of namespace detail
+
+        /**
+         * Changed elements of a T, kept in binary form: each entry is the element index as a varint
+         * followed by the encoded new value. `encode()` prefixes the entry count, `decode()` parses
+         * and validates the result.
+         */
+        template<typename T>
+        class patch
+        {
+            static_assert(reflectable<T> && !std::is_const<T>::value,
+                          "patch requires a non-const reflectable type");
+
+        public:
+            patch() : count_(0) { }
+
+            // Number of changed elements
+            std::size_t size() const { return count_; }
+
+            bool empty() const { return count_ == 0; }
+
+            void clear()
+            {
+                entries_.clear();
+                count_ = 0;
+            }
+
+            // Appends the current value of the n-th element of `t`, readonly elements throw bad_cast
+            void add(std::size_t n, const T &t)
+            {
+                if (n >= tuple_size<T>::value) {
+                    throw std::out_of_range("patch::add");
+                }
+                detail::patch_table<T>::recorders[n](entries_, t);
+                count_++;
+            }
+
+            // Indices of the changed elements, in the order they were recorded
+            std::vector<std::size_t> indices() const
+            {
+                std::vector<std::size_t> ret;
+                ret.reserve(count_);
+                walk(nullptr, &ret);
+                return ret;
+            }
+
+            void apply(T &t) const { walk(&t, nullptr); }
+
+            std::string encode() const
+            {
+                std::string ret;
+                ret.reserve(entries_.size() + 10);
+                detail::wire_write_varint(ret, count_);
+                ret.append(entries_);
+                return ret;
+            }
+
+            static patch decode(const char *data, std::size_t size)
+            {
+                const char *end = data + size;
+                std::uint64_t count;
+                if (!detail::wire_read_varint(data, end, count)) {
+                    throw std::invalid_argument("patch::decode");
+                }
+                patch ret;
+                ret.entries_.assign(data, end);
+                ret.count_ = std::size_t(count);
+                // Validates the entries
+                if (ret.walk(nullptr, nullptr) != count) {
+                    throw std::invalid_argument("patch::decode");
+                }
+                return ret;
+            }
+
+            static patch decode(const std::string &s) { return decode(s.data(), s.size()); }
+
+        private:
+            template<typename U>
+            friend patch<U> diff(const U &a, const U &b);
+
+            std::size_t walk(T *t, std::vector<std::size_t> *indices) const
+            {
+                typedef detail::patch_table<T> table;
+                const char *p = entries_.data();
+                const char *end = p + entries_.size();
+                std::size_t n = 0;
+                while (p != end) {
+                    std::uint64_t index;
+                    if (!detail::wire_read_varint(p, end, index)) {
+                        throw std::invalid_argument("apply_patch");
+                    }
+                    // Out of range and readonly indices are rejected like any malformed entry
+                    if (index >= tuple_size<T>::value || !table::appliers[index](p, end, t)) {
+                        throw std::invalid_argument("apply_patch");
+                    }
+                    if (indices != nullptr) {
+                        indices->push_back(std::size_t(index));
+                    }
+                    n++;
+                }
+                return n;
+            }
+
+            std::string entries_;
+            std::size_t count_;
+        };
+
+        // Patch that turns `a` into `b`, readonly elements are not compared
+        template<typename T>
+        patch<T> diff(const T &a, const T &b)
+        {
+            patch<T> ret;
+            ret.count_ = detail::diff_elements(ret.entries_, a, b,
+                                               std::make_index_sequence<tuple_size<T>::value>());
+            return ret;
+        }
+
+        template<typename T>
+        void apply_patch(T &t, const patch<T> &p)
+        {
+            p.apply(t);
+        }
+    } // End of namespace cxl::reflection
+    using reflection::patch;
+    using reflection::diff;
+    using reflection::apply_patch;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_PATCH_HPP
@@ -1,6 +1,8 @@
 #ifndef CXL_REFLECTION_REFLECTION_IMPL_HPP
 #define CXL_REFLECTION_REFLECTION_IMPL_HPP
 
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <tuple>
@@ -40,31 +42,13 @@
     constexpr std::enable_if_t<!element_has_##NAME<I, T>, const char*> get_##NAME()                \
     {                                                                                              \
         return FALLBACK;                                                                           \
-    }                                                                                              \
-    template <std::size_t I, std::size_t N, typename T>                                            \
-    struct NAME##_getter {                                                                         \
-        const char* operator()(size_t n) const                                                     \
-        {                                                                                          \
-            if (I == n) {                                                                          \
-                return get_##NAME<I, T>();                                                         \
-            }                                                                                      \
-            return NAME##_getter<I + 1, N, T>()(n);                                                \
-        }                                                                                          \
-    };                                                                                             \
-    template <std::size_t N, typename T>                                                           \
-    struct NAME##_getter<N, N, T> {                                                                \
-        template <typename... U>                                                                   \
-        const char* operator()(U...) const                                                         \
-        {                                                                                          \
-            throw std::out_of_range("reflected_getter");                                           \
-        }                                                                                          \
-    };
+    }
 
 #define CXL_ELEM_OP_FUNC(NAME)                                                                     \
     template <typename T>                                                                          \
     const char* get_element_##NAME(std::size_t n)                                                  \
     {                                                                                              \
-        return detail::NAME##_getter<0, tuple_size<T>::value, T>()(n);                             \
+        return get_element_descriptor<T>(n).NAME;                                                  \
     }
 
 #define CXL_OP_IMPL(NAME)                                                                          \
@@ -207,6 +191,9 @@ namespace cxl {
                     }
 
                     static type const &get(owner_type const &d) { return d.first; }
+
+                    template<typename Owner = owner_type>
+                    static constexpr std::size_t offset() { return offsetof(Owner, first); }
                 };
 
                 template<typename Unused>
@@ -244,6 +231,9 @@ namespace cxl {
                     }
 
                     static type const &get(owner_type const &d) { return d.second; }
+
+                    template<typename Owner = owner_type>
+                    static constexpr std::size_t offset() { return offsetof(Owner, second); }
                 };
             };
 
@@ -291,6 +281,8 @@ namespace cxl {
                     }
 
                     static type const &get(owner_type const &d) { return std::get<I>(d); }
+
+                    static constexpr std::size_t offset() { return I * sizeof(T); }
                 };
             };
         };
@@ -394,7 +386,7 @@ namespace cxl {
             };
 
             template<typename T>
-            struct to_variant<T, std::enable_if_t<reflectable<T> && !is_tuple<T>::value>>
+            struct to_variant<T, std::enable_if_t<metadata_t<T>::enabled && !is_tuple<T>::value>>
             {
                 using type = typename to_variant<typename reflected<T>::tuple_type>::type;
             };
@@ -425,18 +417,49 @@ namespace cxl {
         template<typename T>
         using to_variant_t = typename detail::to_variant<T>::type;
 
+        // Depends on metadata only, `reflected<T>` needs complete elements to build its tuple_type
         template<std::size_t I, typename T>
-        struct reflected_element<I, T, std::enable_if_t<reflectable<T> && !std::is_const<T>::value>>
+        struct reflected_element<I, T, std::enable_if_t<metadata_t<T>::enabled && !std::is_const<T>::value>>
                 : public metadata_t<T>::template element<I, void>
         {
         };
 
         template<std::size_t I, typename T>
-        struct reflected_element<I, const T> : public reflected_element<I, T>
+        struct reflected_element<I, const T, std::enable_if_t<reflected<T>::enabled>>
+                : public reflected_element<I, T>
         {
             using type = std::add_const_t<reflected_element_type<I, T>>;
         };
 
+        namespace detail {
+            template<typename E, typename = void>
+            struct has_offset : bool_t<false>
+            {
+            };
+
+            template<typename E>
+            struct has_offset<E, decltype(void(E::offset()))> : bool_t<true>
+            {
+            };
+        } // End of namespace detail
+
+        // Plain members of standard-layout types can be accessed directly by byte offset
+        template<std::size_t I, typename T>
+        constexpr bool element_has_offset = std::is_standard_layout<T>::value
+                                            && detail::has_offset<reflected_element<I, T>>::value;
+
+        template<std::size_t I, typename T>
+        constexpr std::enable_if_t<element_has_offset<I, T>, std::size_t> get_element_offset()
+        {
+            return reflected_element<I, T>::offset();
+        }
+
+        template<std::size_t I, typename T>
+        constexpr std::enable_if_t<!element_has_offset<I, T>, std::size_t> get_element_offset()
+        {
+            return std::size_t(-1);
+        }
+
         template<typename T>
         struct reflected<T, std::enable_if_t<metadata_t<T>::enabled>> : public metadata_t<T>
         {
@@ -449,7 +472,7 @@ namespace cxl {
         };
 
         template<typename T>
-        struct reflected<const T> : public reflected<T>
+        struct reflected<const T, std::enable_if_t<reflected<T>::enabled>> : public reflected<T>
         {
             using tuple_type = typename detail::const_tuple<typename reflected<T>::tuple_type>::type;
         };
@@ -494,197 +517,151 @@ namespace cxl {
         };
 
         namespace detail {
-            template<std::size_t I, std::size_t N, typename T>
-            struct reflected_getter
+            // Accessors of plain members of standard-layout types only depend on the member type, all
+            // members with the same type share one function and differ in the offset argument
+            template<typename T, typename E, typename = void>
+            struct variant_offset_access
             {
                 typedef to_variant_t<T> Variant;
 
-                Variant operator()(const T &t, size_t n) const
+                static Variant get(const T &t, std::size_t offset)
                 {
-                    if (I == n) {
-                        return Variant(reflected_element<I, T>::get(t));
-                    }
-                    return reflected_getter<I + 1, N, T>()(t, n);
+                    return Variant(*reinterpret_cast<const E *>(reinterpret_cast<const char *>(&t)
+                                                                + offset));
                 }
 
-                Variant operator()(const T &t, const std::string &n) const
+                static void set(T &t, const Variant &e, std::size_t offset)
                 {
-                    if (n == reflected_element<I, T>::key()) {
-                        return Variant(reflected_element<I, T>::get(t));
-                    }
-                    return reflected_getter<I + 1, N, T>()(t, n);
+                    *reinterpret_cast<E *>(reinterpret_cast<char *>(&t) + offset) = e.template get<E>();
                 }
-            };
 
-            template<std::size_t N, typename T>
-            struct reflected_getter<N, N, T>
-            {
-                template<typename... U>
-                to_variant_t<T> operator()(U...) const
+                static void move(T &t, Variant &&e, std::size_t offset)
                 {
-                    throw std::out_of_range("reflected_getter");
+                    E &m = *reinterpret_cast<E *>(reinterpret_cast<char *>(&t) + offset);
+                    m = std::move(e).template get<E>();
                 }
             };
 
-            template<std::size_t I, std::size_t N, typename T>
-            struct reflected_setter
+            template<typename T, typename E>
+            struct variant_offset_access<T, E, std::enable_if_t<std::is_const<E>::value>>
             {
                 typedef to_variant_t<T> Variant;
 
-                template<typename U>
-                std::enable_if_t<!std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, const Variant &e, size_t n) const
+                static Variant get(const T &t, std::size_t offset)
                 {
-                    if (I == n) {
-                        reflected_element<I, U>::set(t, e.template get<reflected_element_type<I, U>>());
-                        return;
-                    }
-                    reflected_setter<I + 1, N, U>()(t, e, n);
+                    return Variant(*reinterpret_cast<const E *>(reinterpret_cast<const char *>(&t)
+                                                                + offset));
                 }
 
-                template<typename U>
-                std::enable_if_t<!std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, Variant &&e, size_t n) const
-                {
-                    if (I == n) {
-                        reflected_element<I, U>::set(t, e.template get<reflected_element_type<I, U>>());
-                        return;
-                    }
-                    reflected_setter<I + 1, N, U>()(t, std::forward<Variant>(e), n);
-                }
+                static void set(T &, const Variant &, std::size_t) { throw std::bad_cast(); }
 
-                template<typename U>
-                std::enable_if_t<!std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, const Variant &e, const std::string &n) const
-                {
-                    if (n == reflected_element<I, U>::key()) {
-                        reflected_element<I, U>::set(t, e.template get<reflected_element_type<I, U>>());
-                        return;
-                    }
-                    reflected_setter<I + 1, N, U>()(t, e, n);
-                }
+                static void move(T &, Variant &&, std::size_t) { throw std::bad_cast(); }
+            };
 
-                template<typename U>
-                std::enable_if_t<!std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, Variant &&e, const std::string &n) const
-                {
-                    if (n == reflected_element<I, U>::key()) {
-                        reflected_element<I, U>::set(t, e.template get<reflected_element_type<I, U>>());
-                        return;
-                    }
-                    reflected_setter<I + 1, N, U>()(t, std::forward<Variant>(e), n);
-                }
+            template<std::size_t I, typename T, typename = void>
+            struct variant_element_access
+            {
+                typedef to_variant_t<T> Variant;
 
-                template<typename U, typename V>
-                std::enable_if_t<std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, V &&e, size_t n) const
+                static Variant get(const T &t, std::size_t)
                 {
-                    if (I == n) {
-                        throw std::bad_cast();
-                    }
-                    reflected_setter<I + 1, N, U>()(t, std::forward<Variant>(e), n);
+                    return Variant(reflected_element<I, T>::get(t));
                 }
 
-                template<typename U, typename V>
-                std::enable_if_t<std::is_const<reflected_element_type<I, U>>::value>
-                operator()(U &t, V &&e, const std::string &n) const
+                static void set(T &t, const Variant &e, std::size_t)
                 {
-                    if (n == reflected_element<I, U>::key()) {
-                        throw std::bad_cast();
-                    }
-                    reflected_setter<I + 1, N, U>()(t, std::forward<Variant>(e), n);
+                    reflected_element<I, T>::set(t, e.template get<reflected_element_type<I, T>>());
                 }
-            };
 
-            template<std::size_t N, typename T>
-            struct reflected_setter<N, N, T>
-            {
-                template<typename... U>
-                void operator()(U...) const
+                static void move(T &t, Variant &&e, std::size_t)
                 {
-                    throw std::out_of_range("reflected_setter");
+                    reflected_element<I, T>::set(t,
+                                                 std::move(e).template get<reflected_element_type<I, T>>());
                 }
             };
 
-            template<std::size_t I, std::size_t N, typename T>
-            struct name_getter
+            template<std::size_t I, typename T>
+            struct variant_element_access<I, T,
+                                          std::enable_if_t<std::is_const<reflected_element_type<I, T>>::value>>
             {
-                const char *operator()(size_t n) const
-                {
-                    if (I == n) {
-                        return reflected_element<I, T>::name();
-                    }
-                    return name_getter<I + 1, N, T>()(n);
-                }
+                typedef to_variant_t<T> Variant;
 
-                const char *operator()(const std::string &n) const
+                static Variant get(const T &t, std::size_t)
                 {
-                    if (n == reflected_element<I, T>::key()) {
-                        return reflected_element<I, T>::name();
-                    }
-                    return name_getter<I + 1, N, T>()(n);
+                    return Variant(reflected_element<I, T>::get(t));
                 }
-            };
 
-            template<std::size_t N, typename T>
-            struct name_getter<N, N, T>
-            {
-                template<typename... U>
-                const char *operator()(U...) const
-                {
-                    throw std::out_of_range("reflected_getter");
-                }
+                static void set(T &, const Variant &, std::size_t) { throw std::bad_cast(); }
+
+                static void move(T &, Variant &&, std::size_t) { throw std::bad_cast(); }
             };
 
-            template<std::size_t I, std::size_t N, typename T>
-            struct key_getter
+            template<std::size_t I, typename T>
+            using variant_access = cond<element_has_offset<I, T>,
+                                        variant_offset_access<T, reflected_element_type<I, T>>,
+                                        variant_element_access<I, T>>;
+
+            // Dispatch tables indexed by element index, no recursion
+            template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct variant_accessors;
+
+            template<typename T, std::size_t... I>
+            struct variant_accessors<T, std::index_sequence<I...>>
             {
-                const char *operator()(size_t n) const
+                typedef to_variant_t<T> Variant;
+                typedef Variant (*getter_type)(const T &, std::size_t);
+                typedef void (*setter_type)(T &, const Variant &, std::size_t);
+                typedef void (*mover_type)(T &, Variant &&, std::size_t);
+
+                // Indexed by element index, accessors take offsets[n] as the last argument. One extra
+                // entry, so that the tables of an empty T are not zero-sized
+                static constexpr std::size_t offsets[sizeof...(I) + 1] = {get_element_offset<I, T>()..., 0};
+                static constexpr getter_type getters[sizeof...(I) + 1]
+                        = {&variant_access<I, T>::get..., nullptr};
+                static constexpr setter_type setters[sizeof...(I) + 1]
+                        = {&variant_access<I, T>::set..., nullptr};
+                static constexpr mover_type movers[sizeof...(I) + 1]
+                        = {&variant_access<I, T>::move..., nullptr};
+
+                static Variant get(const T &t, std::size_t n)
                 {
-                    if (I == n) {
-                        return reflected_element<I, T>::key();
+                    if (n >= sizeof...(I)) {
+                        throw std::out_of_range("reflected_getter");
                     }
-                    return key_getter<I + 1, N, T>()(n);
+                    return getters[n](t, offsets[n]);
                 }
 
-                const char *operator()(const std::string &n) const
+                static void set(T &t, const Variant &e, std::size_t n)
                 {
-                    if (n == reflected_element<I, T>::key()) {
-                        return reflected_element<I, T>::key_getter();
+                    if (n >= sizeof...(I)) {
+                        throw std::out_of_range("reflected_setter");
                     }
-                    return key_getter<I + 1, N, T>()(n);
+                    setters[n](t, e, offsets[n]);
                 }
-            };
 
-            template<std::size_t N, typename T>
-            struct key_getter<N, N, T>
-            {
-                template<typename... U>
-                const char *operator()(U...) const
+                static void set(T &t, Variant &&e, std::size_t n)
                 {
-                    throw std::out_of_range("reflected_getter");
+                    if (n >= sizeof...(I)) {
+                        throw std::out_of_range("reflected_setter");
+                    }
+                    movers[n](t, std::move(e), offsets[n]);
                 }
             };
 
-            template<std::size_t I, std::size_t N, typename T>
-            struct member_key_visitor
-            {
-                template<typename F>
-                void operator()(const T &t, F &&f) const
-                {
-                    f(t, I, reflected_element<I, T>::key());
-                    member_key_visitor<I + 1, N, T>()(t, std::forward<F>(f));
-                }
-            };
+            template<typename T, std::size_t... I>
+            constexpr std::size_t variant_accessors<T, std::index_sequence<I...>>::offsets[sizeof...(I) + 1];
 
-            template<std::size_t N, typename T>
-            struct member_key_visitor<N, N, T>
-            {
-                template<typename F>
-                void operator()(const T &t, F &&f) const
-                {
-                }
-            };
+            template<typename T, std::size_t... I>
+            constexpr typename variant_accessors<T, std::index_sequence<I...>>::getter_type
+                    variant_accessors<T, std::index_sequence<I...>>::getters[sizeof...(I) + 1];
+
+            template<typename T, std::size_t... I>
+            constexpr typename variant_accessors<T, std::index_sequence<I...>>::setter_type
+                    variant_accessors<T, std::index_sequence<I...>>::setters[sizeof...(I) + 1];
+
+            template<typename T, std::size_t... I>
+            constexpr typename variant_accessors<T, std::index_sequence<I...>>::mover_type
+                    variant_accessors<T, std::index_sequence<I...>>::movers[sizeof...(I) + 1];
 
             CXL_OP_IMPL(sql_table)
 
@@ -704,16 +681,123 @@ namespace cxl {
             CXL_ELEM_OP_IMPL(csv_field, (reflected_element<I, T>::key()))
         }
 
+        /**
+         * Flat description of a reflected element, every reflected type has a constexpr array of
+         * these so generic code can iterate metadata without template recursion.
+         */
+        struct element_descriptor
+        {
+            std::size_t index;
+            const char *name;
+            const char *key;
+            const char *sql_field;
+            const char *json_key;
+            const char *xml_node;
+            const char *xml_namespace;
+            const char *csv_field;
+            bool use_value;
+            bool readonly;
+            std::size_t offset; // std::size_t(-1) unless a plain member of a standard-layout type
+            std::size_t size;
+            std::size_t alignment;
+        };
+
+        namespace detail {
+            template<std::size_t I, typename T>
+            constexpr element_descriptor make_element_descriptor()
+            {
+                return {I,
+                        reflected_element<I, T>::name(),
+                        reflected_element<I, T>::key(),
+                        get_sql_field<I, T>(),
+                        get_json_key<I, T>(),
+                        get_xml_node<I, T>(),
+                        get_xml_namespace<I, T>(),
+                        get_csv_field<I, T>(),
+                        reflected_element<I, T>::use_value,
+                        std::is_const<reflected_element_type<I, T>>::value,
+                        get_element_offset<I, T>(),
+                        sizeof(reflected_element_type<I, T>),
+                        alignof(reflected_element_type<I, T>)};
+            }
+
+            template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct descriptor_table;
+
+            template<typename T, std::size_t... I>
+            struct descriptor_table<T, std::index_sequence<I...>>
+            {
+                // One extra entry, so that the table of an empty T is not zero-sized
+                static constexpr element_descriptor elements[sizeof...(I) + 1]
+                        = {make_element_descriptor<I, T>()..., element_descriptor{}};
+            };
+
+            template<typename T, std::size_t... I>
+            constexpr element_descriptor
+                    descriptor_table<T, std::index_sequence<I...>>::elements[sizeof...(I) + 1];
+        } // End of namespace detail
+
+        // All element descriptors of T, in index order, there are `tuple_size<T>::value` of them
+        template<typename T>
+        constexpr const element_descriptor *get_element_descriptors()
+        {
+            return detail::descriptor_table<uncv<T>>::elements;
+        }
+
+        template<typename T>
+        constexpr const element_descriptor &get_element_descriptor(std::size_t n)
+        {
+            return n < tuple_size<T>::value ? get_element_descriptors<T>()[n]
+                                            : throw std::out_of_range("get_element_descriptor");
+        }
+
+        namespace detail {
+            constexpr bool key_equal(const char *a, const char *b)
+            {
+                while (*a != '\0' && *a == *b) {
+                    ++a;
+                    ++b;
+                }
+                return *a == *b;
+            }
+
+            template<typename T>
+            constexpr std::size_t find_key(const char *key)
+            {
+                std::size_t n = 0;
+                while (n < tuple_size<T>::value && !key_equal(get_element_descriptors<T>()[n].key, key)) {
+                    n++;
+                }
+                return n;
+            }
+        } // End of namespace detail
+
+        template<typename T>
+        constexpr bool has_element(const char *key)
+        {
+            return detail::find_key<T>(key) < tuple_size<T>::value;
+        }
+
+        /**
+         * Index of the element whose key() is `key`, can be evaluated at compile time, in which case
+         * an unknown key is a compile error, e.g. `std::get<cxl::index_of<S>("MM3")>(s)`.
+         */
+        template<typename T>
+        constexpr std::size_t index_of(const char *key)
+        {
+            return has_element<T>(key) ? detail::find_key<T>(key) : throw std::out_of_range("index_of");
+        }
+
         template<typename T>
         std::enable_if_t<reflectable<T>, to_variant_t<T>> get_variant(size_t n, const T &t)
         {
-            return detail::reflected_getter<0, tuple_size<T>::value, T>()(t, n);
+            return detail::variant_accessors<T>::get(t, n);
         }
 
         template<typename T>
         std::enable_if_t<reflectable<T>, to_variant_t<T>> get_variant(const std::string &n, const T &t)
         {
-            return detail::reflected_getter<0, tuple_size<T>::value, T>()(t, n);
+            return detail::variant_accessors<T>::get(t, detail::find_key<T>(n.c_str()));
         }
 
         template<typename U, typename T>
@@ -731,25 +815,25 @@ namespace cxl {
         template<typename T>
         std::enable_if_t<reflectable<T>, void> set(size_t n, T &t, const to_variant_t<T> &e)
         {
-            detail::reflected_setter<0, tuple_size<T>::value, T>()(t, e, n);
+            detail::variant_accessors<T>::set(t, e, n);
         }
 
         template<typename T>
         std::enable_if_t<reflectable<T>, void> set(size_t n, T &t, to_variant_t<T> &&e)
         {
-            detail::reflected_setter<0, tuple_size<T>::value, T>()(t, std::move(e), n);
+            detail::variant_accessors<T>::set(t, std::move(e), n);
         }
 
         template<typename T>
         std::enable_if_t<reflectable<T>, void> set(const std::string &n, T &t, const to_variant_t<T> &e)
         {
-            detail::reflected_setter<0, tuple_size<T>::value, T>()(t, e, n);
+            detail::variant_accessors<T>::set(t, e, detail::find_key<T>(n.c_str()));
         }
 
         template<typename T>
         std::enable_if_t<reflectable<T>, void> set(const std::string &n, T &t, to_variant_t<T> &&e)
         {
-            detail::reflected_setter<0, tuple_size<T>::value, T>()(t, std::move(e), n);
+            detail::variant_accessors<T>::set(t, std::move(e), detail::find_key<T>(n.c_str()));
         }
 
         template<typename T>
@@ -761,39 +845,66 @@ namespace cxl {
         template<typename T>
         const char *get_element_name(std::size_t n)
         {
-            return detail::name_getter<0, tuple_size<T>::value, T>()(n);
+            return get_element_descriptor<T>(n).name;
         }
 
         template<typename T>
         const char *get_element_key(std::size_t n)
         {
-            return detail::key_getter<0, tuple_size<T>::value, T>()(n);
+            return get_element_descriptor<T>(n).key;
         }
 
         namespace detail {
-            template<std::size_t I, std::size_t N>
-            struct member_enumerator
+            template<typename T, typename V, std::size_t... I>
+            void enumerate(T &&t, V &&v, std::index_sequence<I...>)
+            {
+                typedef int expander[];
+                (void) expander{0, (v(reflected_element<I, unrefcv<T>>::get(std::forward<T>(t))), 0)...};
+            }
+
+            template<typename T, typename V, std::size_t... I>
+            void enumerate_indexed(T &&t, V &&v, std::index_sequence<I...>)
+            {
+                typedef int expander[];
+                (void) expander{0, (v(reflected_element<I, unrefcv<T>>::get(std::forward<T>(t)),
+                                      std::integral_constant<std::size_t, I>(),
+                                      reflected_element<I, unrefcv<T>>()), 0)...};
+            }
+
+            // Ranges of reflectable objects, which the for_each_element of parallel.hpp visits field-wise
+            template<typename T, typename = void>
+            struct is_reflectable_range : std::false_type
             {
-                template<typename T, typename V>
-                void operator()(T &&t, V &&v) const {
-                    v(reflected_element<I, unref<T>>::get(std::forward<T>(t)));
-                    member_enumerator<I+1, N>()(std::forward<T>(t), std::forward<V>(v));
-                }
             };
-            template<std::size_t N>
-            struct member_enumerator<N, N> {
-                template<typename T, typename V>
-                void operator()(T &&t, V &&v) const {
-                }
+
+            template<typename T>
+            struct is_reflectable_range<T, std::enable_if_t<
+                    !reflectable<T> && reflectable<unrefcv<decltype(*std::begin(std::declval<T &>()))>>>>
+                    : std::true_type
+            {
             };
         };
 
         template<typename T, typename V>
-        void for_each_element(T &&t, V &&v) {
-            static_assert(reflectable<unref<T>>, "for_each_element only supports reflectable types.");
-            detail::member_enumerator<0, tuple_size<unref<T>>::value>()(std::forward<T>(t), std::forward<V>(v));
+        std::enable_if_t<!detail::is_reflectable_range<unrefcv<T>>::value> for_each_element(T &&t, V &&v) {
+            static_assert(reflectable<unrefcv<T>>, "for_each_element only supports reflectable types.");
+            detail::enumerate(std::forward<T>(t), v, std::make_index_sequence<tuple_size<unrefcv<T>>::value>());
         };
 
+        /**
+         * Same as for_each_element, but fully unrolled and `v` is called as
+         * `v(value, std::integral_constant<std::size_t, I>(), reflected_element<I, T>())`,
+         * so the callback knows the index and metadata of each element at compile time.
+         */
+        template<typename T, typename V>
+        void for_each_element_indexed(T &&t, V &&v)
+        {
+            static_assert(reflectable<unrefcv<T>>,
+                          "for_each_element_indexed only supports reflectable types.");
+            detail::enumerate_indexed(std::forward<T>(t), v,
+                                      std::make_index_sequence<tuple_size<unrefcv<T>>::value>());
+        }
+
         CXL_OP_FUNC(sql_table, (reflected<T>::name()))
 
         CXL_OP_FUNC(xml_node, (reflected<T>::name()))
@@ -828,7 +939,13 @@ namespace cxl {
     using reflection::get_element_xml_node;
     using reflection::get_element_xml_namespace;
     using reflection::get_element_csv_field;
+    using reflection::element_descriptor;
+    using reflection::get_element_descriptors;
+    using reflection::get_element_descriptor;
+    using reflection::has_element;
+    using reflection::index_of;
     using reflection::for_each_element;
+    using reflection::for_each_element_indexed;
 } // End of namespace cxl
 
 namespace std {
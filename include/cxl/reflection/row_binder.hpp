@@ -0,0 +1,497 @@
+#ifndef CXL_REFLECTION_ROW_BINDER_HPP
+#define CXL_REFLECTION_ROW_BINDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <typeinfo>
+#include <initializer_list>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Text to value conversions, return false if [begin, end) is not a valid representation
+            template<typename E>
+            std::enable_if_t<std::is_integral<E>::value && std::is_signed<E>::value, bool>
+            parse_text(const char *begin, const char *end, E &out)
+            {
+                typedef std::make_unsigned_t<E> U;
+                bool negative = begin != end && *begin == '-';
+                if (begin != end && (*begin == '-' || *begin == '+')) {
+                    ++begin;
+                }
+                if (begin == end) {
+                    return false;
+                }
+                U limit = U(std::numeric_limits<E>::max()) + (negative ? 1 : 0);
+                U value = 0;
+                for (; begin != end; ++begin) {
+                    unsigned d = static_cast<unsigned char>(*begin) - '0';
+                    if (d > 9 || value > (limit - d) / 10) {
+                        return false;
+                    }
+                    value = value * 10 + d;
+                }
+                out = negative ? E(U(0) - value) : E(value);
+                return true;
+            }
+
+            template<typename E>
+            std::enable_if_t<std::is_integral<E>::value && std::is_unsigned<E>::value
+                             && !std::is_same<E, bool>::value, bool>
+            parse_text(const char *begin, const char *end, E &out)
+            {
+                if (begin != end && *begin == '+') {
+                    ++begin;
+                }
+                if (begin == end) {
+                    return false;
+                }
+                E value = 0;
+                for (; begin != end; ++begin) {
+                    unsigned d = static_cast<unsigned char>(*begin) - '0';
+                    if (d > 9 || value > (std::numeric_limits<E>::max() - d) / 10) {
+                        return false;
+                    }
+                    value = E(value * 10 + d);
+                }
+                out = value;
+                return true;
+            }
+
+            inline bool parse_text(const char *begin, const char *end, bool &out)
+            {
+                std::size_t n = std::size_t(end - begin);
+                if ((n == 1 && *begin == '1') || (n == 4 && std::memcmp(begin, "true", 4) == 0)) {
+                    out = true;
+                    return true;
+                }
+                if ((n == 1 && *begin == '0') || (n == 5 && std::memcmp(begin, "false", 5) == 0)) {
+                    out = false;
+                    return true;
+                }
+                return false;
+            }
+
+            inline float parse_float(const char *s, char **stop, float)
+            {
+                return std::strtof(s, stop);
+            }
+
+            inline double parse_float(const char *s, char **stop, double)
+            {
+                return std::strtod(s, stop);
+            }
+
+            inline long double parse_float(const char *s, char **stop, long double)
+            {
+                return std::strtold(s, stop);
+            }
+
+            // "[-]ddd.ddd" with at most 15 significant digits: both the digits and the power of 10 are
+            // exact doubles, so one division is correctly rounded, like strtod
+            inline bool parse_decimal(const char *begin, const char *end, double &out)
+            {
+                static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                                1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+                bool negative = begin != end && *begin == '-';
+                const char *p = negative ? begin + 1 : begin;
+                std::uint64_t digits = 0;
+                int count = 0;
+                int scale = -1;
+                for (; p != end; ++p) {
+                    if (*p == '.' && scale < 0) {
+                        scale = 0;
+                        continue;
+                    }
+                    unsigned d = static_cast<unsigned char>(*p) - '0';
+                    if (d > 9 || ++count > 15) {
+                        return false;
+                    }
+                    digits = digits * 10 + d;
+                    scale += scale >= 0 ? 1 : 0;
+                }
+                if (count == 0) {
+                    return false;
+                }
+                double value = double(digits) / powers[scale < 0 ? 0 : scale];
+                out = negative ? -value : value;
+                return true;
+            }
+
+            // "[+-]ddd[.ddd][(e|E)[+-]ddd]" with a digit at least before the exponent: what strtod accepts
+            // minus leading whitespace, hex floats, infinities and NaNs
+            inline bool is_decimal(const char *p, const char *end)
+            {
+                auto digits = [&p, end]() {
+                    const char *start = p;
+                    while (p != end && unsigned(static_cast<unsigned char>(*p) - '0') <= 9) {
+                        ++p;
+                    }
+                    return std::size_t(p - start);
+                };
+                if (p != end && (*p == '-' || *p == '+')) {
+                    ++p;
+                }
+                std::size_t n = digits();
+                if (p != end && *p == '.') {
+                    ++p;
+                    n += digits();
+                }
+                if (n == 0) {
+                    return false;
+                }
+                if (p != end && (*p == 'e' || *p == 'E')) {
+                    ++p;
+                    if (p != end && (*p == '-' || *p == '+')) {
+                        ++p;
+                    }
+                    if (digits() == 0) {
+                        return false;
+                    }
+                }
+                return p == end;
+            }
+
+            // The NaN and infinity spellings of "%f": "nan", "-nan", "inf" and "-inf"
+            template<typename E>
+            bool parse_nonfinite(const char *begin, const char *end, E &out)
+            {
+                bool negative = begin != end && *begin == '-';
+                std::size_t n = std::size_t(end - begin) - (negative ? 1 : 0);
+                if (n != 3) {
+                    return false;
+                }
+                E value;
+                if (std::memcmp(begin + negative, "nan", 3) == 0) {
+                    value = std::numeric_limits<E>::quiet_NaN();
+                } else if (std::memcmp(begin + negative, "inf", 3) == 0) {
+                    value = std::numeric_limits<E>::infinity();
+                } else {
+                    return false;
+                }
+                out = negative ? -value : value;
+                return true;
+            }
+
+            template<typename E>
+            std::enable_if_t<std::is_floating_point<E>::value, bool>
+            parse_text(const char *begin, const char *end, E &out)
+            {
+                if (std::is_same<E, double>::value) {
+                    double value;
+                    if (parse_decimal(begin, end, value)) {
+                        out = E(value);
+                        return true;
+                    }
+                }
+                if (!is_decimal(begin, end)) {
+                    return parse_nonfinite(begin, end, out);
+                }
+                // strtod needs a terminated string, long ones (e.g. many digits) go to the heap
+                char buf[128];
+                std::string heap;
+                char *text = buf;
+                std::size_t n = std::size_t(end - begin);
+                if (n < sizeof(buf)) {
+                    std::memcpy(buf, begin, n);
+                    buf[n] = '\0';
+                } else {
+                    heap.assign(begin, end);
+                    text = &heap[0];
+                }
+                char *stop = nullptr;
+                E value = parse_float(text, &stop, E());
+                if (stop != text + n) {
+                    return false;
+                }
+                out = value;
+                return true;
+            }
+
+            template<typename Traits, typename Allocator>
+            bool parse_text(const char *begin, const char *end, std::basic_string<char, Traits, Allocator> &out)
+            {
+                out.assign(begin, end);
+                return true;
+            }
+
+            template<typename E, typename = void>
+            struct is_parsable : bool_t<false>
+            {
+            };
+
+            template<typename E>
+            struct is_parsable<E, decltype(void(parse_text(nullptr, nullptr, std::declval<E &>())))>
+                    : bool_t<true>
+            {
+            };
+
+            template<typename E>
+            std::enable_if_t<is_parsable<E>::value> parse_value(const char *data, std::size_t size, E &out)
+            {
+                if (!parse_text(data, data + size, out)) {
+                    throw std::invalid_argument("cannot parse \"" + std::string(data, size) + "\"");
+                }
+            }
+
+            template<typename E>
+            std::enable_if_t<!is_parsable<E>::value> parse_value(const char *, std::size_t, E &)
+            {
+                throw std::bad_cast();
+            }
+
+            typedef void (*text_setter)(void *, const char *, std::size_t, std::size_t);
+
+            // Same sharing scheme as variant_accessors, plain members are parsed in place
+            template<typename T, typename E>
+            void parse_at_offset(void *t, const char *data, std::size_t size, std::size_t offset)
+            {
+                parse_value(data, size, *reinterpret_cast<E *>(static_cast<char *>(t) + offset));
+            }
+
+            template<std::size_t I, typename T>
+            void parse_element(void *t, const char *data, std::size_t size, std::size_t)
+            {
+                unrefcv<reflected_element_type<I, T>> value;
+                parse_value(data, size, value);
+                reflected_element<I, T>::set(*static_cast<T *>(t), std::move(value));
+            }
+
+            template<std::size_t I, typename T>
+            constexpr std::enable_if_t<std::is_const<reflected_element_type<I, T>>::value, text_setter>
+            text_setter_of()
+            {
+                return nullptr;
+            }
+
+            template<std::size_t I, typename T>
+            constexpr std::enable_if_t<!std::is_const<reflected_element_type<I, T>>::value
+                                       && element_has_offset<I, T>, text_setter>
+            text_setter_of()
+            {
+                return &parse_at_offset<T, reflected_element_type<I, T>>;
+            }
+
+            template<std::size_t I, typename T>
+            constexpr std::enable_if_t<!std::is_const<reflected_element_type<I, T>>::value
+                                       && !element_has_offset<I, T>, text_setter>
+            text_setter_of()
+            {
+                return &parse_element<I, T>;
+            }
+
+            template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+            struct text_setters;
+
+            template<typename T, std::size_t... I>
+            struct text_setters<T, std::index_sequence<I...>>
+            {
+                // One extra entry, so that the table of an empty T is not zero-sized
+                static constexpr text_setter setters[sizeof...(I) + 1] = {text_setter_of<I, T>()..., nullptr};
+            };
+
+            template<typename T, std::size_t... I>
+            constexpr text_setter text_setters<T, std::index_sequence<I...>>::setters[sizeof...(I) + 1];
+        } // End of namespace detail
+
+        /**
+         * Maps a list of external column names (e.g. a CSV header) to elements of T once, then
+         * assigns rows of variants or text through the precomputed column-to-element slots.
+         *
+         * A column matches the element whose key(), or failing that csv_field(), equals its name.
+         * Columns matching no writable element are unmapped and ignored on assignment, writable
+         * elements matched by no column are missing and left untouched.
+         */
+        template<typename T>
+        class row_binder
+        {
+            static_assert(reflectable<T> && !std::is_const<T>::value,
+                          "row_binder requires a non-const reflectable type");
+
+            typedef detail::variant_accessors<T> accessors;
+
+            struct slot
+            {
+                std::size_t index;
+                std::size_t offset;
+                typename accessors::setter_type set;
+                typename accessors::mover_type move;
+                detail::text_setter parse;
+            };
+
+        public:
+            typedef to_variant_t<T> variant_type;
+
+            static constexpr std::size_t npos = std::size_t(-1);
+
+            template<typename Names>
+            explicit row_binder(const Names &names)
+            {
+                for (const auto &name : names) {
+                    add_column(name);
+                }
+                finish();
+            }
+
+            row_binder(std::initializer_list<std::string> names)
+            {
+                for (const std::string &name : names) {
+                    add_column(name);
+                }
+                finish();
+            }
+
+            std::size_t columns() const { return slots_.size(); }
+
+            // Element index bound to the column, npos if the column is unmapped
+            std::size_t element_index(std::size_t column) const { return slots_.at(column).index; }
+
+            bool mapped(std::size_t column) const { return element_index(column) != npos; }
+
+            const std::vector<std::size_t> &unmapped_columns() const { return unmapped_; }
+
+            const std::vector<std::size_t> &missing_elements() const { return missing_; }
+
+            bool complete() const { return unmapped_.empty() && missing_.empty(); }
+
+            void assign(T &t, std::size_t column, const variant_type &v) const
+            {
+                const slot &s = slot_at(column);
+                if (s.index != npos) {
+                    s.set(t, v, s.offset);
+                }
+            }
+
+            void assign(T &t, std::size_t column, variant_type &&v) const
+            {
+                const slot &s = slot_at(column);
+                if (s.index != npos) {
+                    s.move(t, std::move(v), s.offset);
+                }
+            }
+
+            // Parses text into the element bound to the column, throws std::invalid_argument if the
+            // text is malformed or the column is past the header and std::bad_cast if the element type
+            // cannot be parsed from text
+            void parse(T &t, std::size_t column, const char *data, std::size_t size) const
+            {
+                const slot &s = slot_at(column);
+                if (s.index != npos) {
+                    s.parse(&t, data, size, s.offset);
+                }
+            }
+
+            void parse(T &t, std::size_t column, const std::string &text) const
+            {
+                parse(t, column, text.data(), text.size());
+            }
+
+            // `row` is a sequence of `variant_type` with exactly columns() entries
+            template<typename Row>
+            void assign_row(T &t, Row &&row) const
+            {
+                std::size_t column = 0;
+                for (auto &&v : row) {
+                    check_column(column);
+                    assign(t, column++, std::forward<decltype(v)>(v));
+                }
+                check_count(column);
+            }
+
+            // `row` is a sequence of strings with exactly columns() entries
+            template<typename Row>
+            void parse_row(T &t, const Row &row) const
+            {
+                std::size_t column = 0;
+                for (const auto &text : row) {
+                    check_column(column);
+                    parse(t, column++, text);
+                }
+                check_count(column);
+            }
+
+        private:
+            void add_column(const std::string &name)
+            {
+                const element_descriptor *d = get_element_descriptors<T>();
+                std::size_t n = detail::find_key<T>(name.c_str());
+                if (n == tuple_size<T>::value) {
+                    n = 0;
+                    while (n < tuple_size<T>::value && name != d[n].csv_field) {
+                        n++;
+                    }
+                }
+                if (n == tuple_size<T>::value || d[n].readonly) {
+                    unmapped_.push_back(slots_.size());
+                    slots_.push_back(slot{npos, npos, nullptr, nullptr, nullptr});
+                    return;
+                }
+                slots_.push_back(slot{n,
+                                      accessors::offsets[n],
+                                      accessors::setters[n],
+                                      accessors::movers[n],
+                                      detail::text_setters<T>::setters[n]});
+            }
+
+            void finish()
+            {
+                const element_descriptor *d = get_element_descriptors<T>();
+                for (std::size_t n = 0; n < tuple_size<T>::value; n++) {
+                    if (d[n].readonly) {
+                        continue;
+                    }
+                    bool found = false;
+                    for (const slot &s : slots_) {
+                        found = found || s.index == n;
+                    }
+                    if (!found) {
+                        missing_.push_back(n);
+                    }
+                }
+            }
+
+            // Records may have more columns than the header
+            const slot &slot_at(std::size_t column) const
+            {
+                if (column >= slots_.size()) {
+                    throw std::invalid_argument("row_binder: column " + std::to_string(column)
+                                                + " is past the header");
+                }
+                return slots_[column];
+            }
+
+            void check_column(std::size_t column) const
+            {
+                if (column >= slots_.size()) {
+                    throw std::out_of_range("row_binder: too many columns");
+                }
+            }
+
+            void check_count(std::size_t count) const
+            {
+                if (count != slots_.size()) {
+                    throw std::out_of_range("row_binder: too few columns");
+                }
+            }
+
+            std::vector<slot> slots_;
+            std::vector<std::size_t> unmapped_;
+            std::vector<std::size_t> missing_;
+        };
+
+        template<typename T>
+        constexpr std::size_t row_binder<T>::npos;
+    } // End of namespace cxl::reflection
+    using reflection::row_binder;
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_ROW_BINDER_HPP
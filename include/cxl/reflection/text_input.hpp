@@ -0,0 +1,184 @@
+#ifndef CXL_REFLECTION_TEXT_INPUT_HPP
+#define CXL_REFLECTION_TEXT_INPUT_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__AVX2__))
+#include <immintrin.h>
+#ifndef CXL_REFLECTION_SIMD_SCAN
+#define CXL_REFLECTION_SIMD_SCAN 1
+#endif
+#endif
+
+// Input primitives shared by the text readers
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // Outcome of scanning buffered input
+            enum class scan_result
+            {
+                ok, need_more, end_of_input
+            };
+
+            // Input in memory, or read from a streambuf in blocks. Unconsumed bytes are kept at
+            // the front of the buffer, which grows if a single record does not fit.
+            class input
+            {
+            public:
+                input(const char *data, std::size_t size)
+                        : sb_(nullptr), begin_(data), end_(data + size), eof_(true)
+                {
+                }
+
+                input(std::streambuf &sb, std::size_t block)
+                        : sb_(&sb),
+                          buffer_(block < 64 ? 64 : block),
+                          begin_(buffer_.data()),
+                          end_(begin_),
+                          eof_(false)
+                {
+                }
+
+                const char *&pos() { return begin_; }
+
+                const char *end() const { return end_; }
+
+                bool eof() const { return eof_; }
+
+                // Keeps [from, end) and appends more input after it, `from` must not be past end()
+                void refill(const char *from)
+                {
+                    std::size_t kept = std::size_t(end_ - from);
+                    if (kept == buffer_.size()) {
+                        std::vector<char> bigger(buffer_.size() * 2);
+                        std::memcpy(bigger.data(), from, kept);
+                        buffer_.swap(bigger);
+                    } else {
+                        std::memmove(buffer_.data(), from, kept);
+                    }
+                    std::streamsize room = std::streamsize(buffer_.size() - kept);
+                    std::streamsize n = sb_->sgetn(buffer_.data() + kept, room);
+                    eof_ = n <= 0;
+                    begin_ = buffer_.data();
+                    end_ = begin_ + kept + (n > 0 ? std::size_t(n) : 0);
+                }
+
+            private:
+                std::streambuf *sb_;
+                std::vector<char> buffer_;
+                const char *begin_;
+                const char *end_;
+                bool eof_;
+            };
+
+            /*
+             * Record-at-a-time reading shared by the text readers, over an input owned here. Derived
+             * either has its own `bool read(T &)`, or gets the one below by providing
+             * `scan_result scan_record(const char *&begin, const char *&end)`, which finds the bounds
+             * of the next record in input_, and `void parse_record(begin, end, T &)`.
+             */
+            template<typename Derived, typename T>
+            class record_reader
+            {
+            public:
+                static constexpr std::size_t default_buffer_size = 1 << 16;
+
+                // Number of records read so far
+                std::size_t records() const { return records_; }
+
+                // Parses the next record into `t`, false at the end of input
+                bool read(T &t)
+                {
+                    Derived &self = static_cast<Derived &>(*this);
+                    for (;;) {
+                        const char *begin = nullptr;
+                        const char *end = nullptr;
+                        scan_result r = self.scan_record(begin, end);
+                        if (r == scan_result::end_of_input) {
+                            return false;
+                        }
+                        if (r == scan_result::ok) {
+                            self.parse_record(begin, end, t);
+                            input_.pos() = end;
+                            records_++;
+                            return true;
+                        }
+                        input_.refill(input_.pos());
+                    }
+                }
+
+                // Reads value-initialized T's until the end of input
+                template<typename OutputIterator>
+                std::size_t read_all(OutputIterator &&oi)
+                {
+                    return for_each([&oi](T &&t) { (*oi++) = std::move(t); });
+                }
+
+                // Calls `f(T &&)` with each record until the end of input
+                template<typename F>
+                std::size_t for_each(F &&f)
+                {
+                    std::size_t n = 0;
+                    for (;;) {
+                        T t{};
+                        if (!static_cast<Derived &>(*this).read(t)) {
+                            return n;
+                        }
+                        f(std::move(t));
+                        n++;
+                    }
+                }
+
+            protected:
+                record_reader(const char *data, std::size_t size) : input_(data, size) { }
+
+                record_reader(std::streambuf &sb, std::size_t buffer_size) : input_(sb, buffer_size) { }
+
+                input input_;
+                std::size_t records_ = 0;
+            };
+
+            template<typename Derived, typename T>
+            constexpr std::size_t record_reader<Derived, T>::default_buffer_size;
+
+            // First char in [p, end) that is `a` or `b`, or end
+            inline const char *find_either(const char *p, const char *end, char a, char b)
+            {
+#ifdef CXL_REFLECTION_SIMD_SCAN
+#ifdef __AVX2__
+                const __m256i a32 = _mm256_set1_epi8(a);
+                const __m256i b32 = _mm256_set1_epi8(b);
+                for (; end - p >= 32; p += 32) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                    __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, a32), _mm256_cmpeq_epi8(v, b32));
+                    unsigned mask = unsigned(_mm256_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                const __m128i a16 = _mm_set1_epi8(a);
+                const __m128i b16 = _mm_set1_epi8(b);
+                for (; end - p >= 16; p += 16) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, a16), _mm_cmpeq_epi8(v, b16));
+                    unsigned mask = unsigned(_mm_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                while (p != end && *p != a && *p != b) {
+                    ++p;
+                }
+                return p;
+            }
+        } // End of namespace cxl::reflection::detail
+    } // End of namespace cxl::reflection
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_TEXT_INPUT_HPP
@@ -0,0 +1,351 @@
+#ifndef CXL_REFLECTION_TEXT_SINK_HPP
+#define CXL_REFLECTION_TEXT_SINK_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__AVX2__))
+#include <immintrin.h>
+#ifndef CXL_REFLECTION_SIMD_SCAN
+#define CXL_REFLECTION_SIMD_SCAN 1
+#endif
+#endif
+
+// Output primitives shared by the text serializers
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // True for '"', '\\' and control chars, the chars both CSV and JSON strings escape
+            inline bool needs_escape(char c)
+            {
+                // '\t', '\r' and '\n' are below 32 too
+                return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 32;
+            }
+
+            // First char in [p, end) that needs_escape, or end
+            inline const char *find_escape(const char *p, const char *end)
+            {
+#ifdef CXL_REFLECTION_SIMD_SCAN
+#ifdef __AVX2__
+                const __m256i quote32 = _mm256_set1_epi8('"');
+                const __m256i backslash32 = _mm256_set1_epi8('\\');
+                const __m256i control32 = _mm256_set1_epi8(31);
+                for (; end - p >= 32; p += 32) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                    // max(v, 31) == 31 iff v < 32 unsigned
+                    __m256i hit = _mm256_or_si256(
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, backslash32)),
+                            _mm256_cmpeq_epi8(_mm256_max_epu8(v, control32), control32));
+                    unsigned mask = unsigned(_mm256_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                const __m128i quote = _mm_set1_epi8('"');
+                const __m128i backslash = _mm_set1_epi8('\\');
+                const __m128i control = _mm_set1_epi8(31);
+                for (; end - p >= 16; p += 16) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    __m128i hit = _mm_or_si128(
+                            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                            _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+                    unsigned mask = unsigned(_mm_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                while (p != end && !needs_escape(*p)) {
+                    ++p;
+                }
+                return p;
+            }
+
+            // True for '<', '>', '&', '"' and control chars, the chars XML text may need to replace
+            inline bool is_markup(char c)
+            {
+                return c == '<' || c == '>' || c == '&' || c == '"' || static_cast<unsigned char>(c) < 32;
+            }
+
+            // First char in [p, end) that is_markup, or end
+            inline const char *find_markup(const char *p, const char *end)
+            {
+#ifdef CXL_REFLECTION_SIMD_SCAN
+#ifdef __AVX2__
+                const __m256i lt32 = _mm256_set1_epi8('<');
+                const __m256i gt32 = _mm256_set1_epi8('>');
+                const __m256i amp32 = _mm256_set1_epi8('&');
+                const __m256i quote32 = _mm256_set1_epi8('"');
+                const __m256i control32 = _mm256_set1_epi8(31);
+                for (; end - p >= 32; p += 32) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                    __m256i angle = _mm256_or_si256(_mm256_cmpeq_epi8(v, lt32), _mm256_cmpeq_epi8(v, gt32));
+                    __m256i other = _mm256_or_si256(_mm256_cmpeq_epi8(v, amp32),
+                                                    _mm256_cmpeq_epi8(v, quote32));
+                    __m256i hit = _mm256_or_si256(
+                            _mm256_or_si256(angle, other),
+                            _mm256_cmpeq_epi8(_mm256_max_epu8(v, control32), control32));
+                    unsigned mask = unsigned(_mm256_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                const __m128i lt = _mm_set1_epi8('<');
+                const __m128i gt = _mm_set1_epi8('>');
+                const __m128i amp = _mm_set1_epi8('&');
+                const __m128i quote = _mm_set1_epi8('"');
+                const __m128i control = _mm_set1_epi8(31);
+                for (; end - p >= 16; p += 16) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    __m128i angle = _mm_or_si128(_mm_cmpeq_epi8(v, lt), _mm_cmpeq_epi8(v, gt));
+                    __m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, quote));
+                    __m128i hit = _mm_or_si128(_mm_or_si128(angle, other),
+                                               _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+                    unsigned mask = unsigned(_mm_movemask_epi8(hit));
+                    if (mask != 0) {
+                        return p + __builtin_ctz(mask);
+                    }
+                }
+#endif
+                while (p != end && !is_markup(*p)) {
+                    ++p;
+                }
+                return p;
+            }
+
+            // Sink over an output iterator, one char at a time
+            template<typename OutputIterator>
+            struct iterator_sink
+            {
+                void put(char c)
+                {
+                    (*i++) = c;
+                    count++;
+                }
+
+                void append(const char *s, std::size_t n)
+                {
+                    for (std::size_t k = 0; k < n; k++) {
+                        (*i++) = s[k];
+                    }
+                    count += n;
+                }
+
+                OutputIterator &i;
+                std::size_t count;
+            };
+
+            // Sink appending to a string
+            struct string_sink
+            {
+                void put(char c) { s.push_back(c); }
+
+                void append(const char *p, std::size_t n) { s.append(p, n); }
+
+                std::string &s;
+            };
+
+            // Sink over a contiguous buffer, flushed to a streambuf in whole blocks
+            class buffer_sink
+            {
+            public:
+                buffer_sink(std::streambuf &sb, char *buffer, std::size_t size)
+                        : sb_(sb), begin_(buffer), cur_(buffer), end_(buffer + size), flushed_(0)
+                {
+                    if (size < 64) {
+                        throw std::invalid_argument("writer: buffer is too small");
+                    }
+                }
+
+                void put(char c)
+                {
+                    if (cur_ == end_) {
+                        flush();
+                    }
+                    *cur_++ = c;
+                }
+
+                void append(const char *s, std::size_t n)
+                {
+                    while (n > std::size_t(end_ - cur_)) {
+                        std::size_t k = std::size_t(end_ - cur_);
+                        std::memcpy(cur_, s, k);
+                        cur_ += k;
+                        s += k;
+                        n -= k;
+                        flush();
+                    }
+                    std::memcpy(cur_, s, n);
+                    cur_ += n;
+                }
+
+                void flush()
+                {
+                    std::streamsize n = cur_ - begin_;
+                    if (n > 0 && sb_.sputn(begin_, n) != n) {
+                        throw std::runtime_error("writer: write failed");
+                    }
+                    flushed_ += std::size_t(n);
+                    cur_ = begin_;
+                }
+
+                // Bytes written so far, flushed or not
+                std::size_t size() const { return flushed_ + std::size_t(cur_ - begin_); }
+
+            private:
+                std::streambuf &sb_;
+                char *begin_;
+                char *cur_;
+                char *end_;
+                std::size_t flushed_;
+            };
+
+            constexpr char digit_pairs[] = "00010203040506070809"
+                                           "10111213141516171819"
+                                           "20212223242526272829"
+                                           "30313233343536373839"
+                                           "40414243444546474849"
+                                           "50515253545556575859"
+                                           "60616263646566676869"
+                                           "70717273747576777879"
+                                           "80818283848586878889"
+                                           "90919293949596979899";
+
+            // Writes the decimal digits of `v` backwards, ending at `end`, returns the first digit
+            template<typename U>
+            char *format_unsigned(U v, char *end)
+            {
+                while (v >= 100) {
+                    std::size_t k = std::size_t(v % 100) * 2;
+                    v /= 100;
+                    *--end = digit_pairs[k + 1];
+                    *--end = digit_pairs[k];
+                }
+                if (v >= 10) {
+                    std::size_t k = std::size_t(v) * 2;
+                    *--end = digit_pairs[k + 1];
+                    *--end = digit_pairs[k];
+                } else {
+                    *--end = char('0' + v);
+                }
+                return end;
+            }
+
+            // Same digits as std::to_string, backwards from `end`, 24 chars are always enough
+            template<typename T>
+            char *format_integer(T t, char *end)
+            {
+                typedef std::conditional_t<std::is_same<T, bool>::value, unsigned, T> I;
+                typedef std::make_unsigned_t<I> U;
+                bool negative = t < T(0);
+                char *p = format_unsigned(negative ? U(U(0) - U(t)) : U(t), end);
+                if (negative) {
+                    *--p = '-';
+                }
+                return p;
+            }
+
+            template<typename F>
+            struct float_format;
+
+            template<>
+            struct float_format<float>
+            {
+                static constexpr double exact_limit = 16777216.0;      // 2^24
+                static constexpr int max_scale = 10;                   // 10^10 is exact in a float
+                static float read(const char *s) { return std::strtof(s, nullptr); }
+            };
+
+            template<>
+            struct float_format<double>
+            {
+                static constexpr double exact_limit = 9007199254740992.0;  // 2^53
+                static constexpr int max_scale = 22;                       // 10^22 is exact in a double
+                static double read(const char *s) { return std::strtod(s, nullptr); }
+            };
+
+            template<>
+            struct float_format<long double>
+            {
+                static constexpr double exact_limit = 0;
+                static constexpr int max_scale = -1;
+                static long double read(const char *s) { return std::strtold(s, nullptr); }
+            };
+
+            constexpr double powers_of_10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                               1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+                                               1e20, 1e21, 1e22};
+
+            /*
+             * Shortest decimal that reads back as the finite `t`, written to `buf` (at least 40
+             * chars), returns its length. If t == m / 10^k with m < 2^p and 10^k exact in F, the
+             * quotient is correctly rounded like the parser's, so the smallest such k is tried
+             * first; other values go through "%.*g" with increasing precision.
+             */
+            template<typename F>
+            std::size_t format_float(F t, char *buf)
+            {
+                typedef float_format<F> format;
+                F a = std::fabs(t);
+                for (int k = 0; k <= format::max_scale && a < format::exact_limit; k++) {
+                    F p = F(powers_of_10[k]);
+                    F m = std::nearbyint(a * p);
+                    if (m >= F(format::exact_limit)) {
+                        break;
+                    }
+                    if (m / p != a) {
+                        continue;
+                    }
+                    char digits[24];
+                    char *end = digits + sizeof(digits);
+                    char *first = format_unsigned(static_cast<std::uint64_t>(m), end);
+                    std::size_t size = std::size_t(end - first);
+                    char *o = buf;
+                    if (std::signbit(t)) {
+                        *o++ = '-';
+                    }
+                    if (std::size_t(k) >= size) {
+                        *o++ = '0';
+                        *o++ = '.';
+                        for (std::size_t z = size; z < std::size_t(k); z++) {
+                            *o++ = '0';
+                        }
+                        std::memcpy(o, first, size);
+                        o += size;
+                    } else {
+                        std::memcpy(o, first, size - std::size_t(k));
+                        o += size - std::size_t(k);
+                        if (k > 0) {
+                            *o++ = '.';
+                            std::memcpy(o, end - k, std::size_t(k));
+                            o += k;
+                        }
+                    }
+                    return std::size_t(o - buf);
+                }
+                int n = 0;
+                for (int precision = std::numeric_limits<F>::digits10;
+                     precision <= std::numeric_limits<F>::max_digits10; precision++) {
+                    n = std::snprintf(buf, 40, "%.*Lg", precision, static_cast<long double>(t));
+                    if (format::read(buf) == t) {
+                        break;
+                    }
+                }
+                return std::size_t(n);
+            }
+        } // End of namespace cxl::reflection::detail
+    } // End of namespace cxl::reflection
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_TEXT_SINK_HPP
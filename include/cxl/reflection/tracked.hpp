@@ -0,0 +1,198 @@
+#ifndef CXL_REFLECTION_TRACKED_HPP
+#define CXL_REFLECTION_TRACKED_HPP
+
+#include <cstddef>
+#include <bitset>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/patch.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            struct tracked_access;
+        } // End of namespace detail
+
+        /**
+         * A reflectable T with one dirty bit per element, set by every write that goes through the
+         * wrapper: `set<I>(v)`, `set(n, t, v)`/`set(key, t, v)` and non-const `std::get<I>`.
+         * `checkpoint()` clears the bits, so serializers can write only what changed since then.
+         */
+        template<typename T>
+        class tracked
+        {
+            static_assert(reflectable<T> && !std::is_const<T>::value,
+                          "tracked requires a non-const reflectable type");
+
+        public:
+            typedef T value_type;
+            typedef std::bitset<tuple_size<T>::value> mask_type;
+
+            tracked() = default;
+
+            explicit tracked(const T &value) : value_(value) { }
+
+            explicit tracked(T &&value) : value_(std::move(value)) { }
+
+            const T &value() const { return value_; }
+
+            const T *operator->() const { return &value_; }
+
+            template<std::size_t I>
+            decltype(auto) get() const
+            {
+                return reflected_element<I, T>::get(value_);
+            }
+
+            template<std::size_t I, typename V>
+            void set(V &&v)
+            {
+                reflected_element<I, T>::set(value_, std::forward<V>(v));
+                dirty_.set(I);
+            }
+
+            void set(std::size_t n, const to_variant_t<T> &v)
+            {
+                reflection::set(n, value_, v);
+                dirty_.set(n);
+            }
+
+            void set(std::size_t n, to_variant_t<T> &&v)
+            {
+                reflection::set(n, value_, std::move(v));
+                dirty_.set(n);
+            }
+
+            // Marks the n-th element dirty, for writes made behind the wrapper's back
+            void touch(std::size_t n)
+            {
+                if (n >= tuple_size<T>::value) {
+                    throw std::out_of_range("tracked::touch");
+                }
+                dirty_.set(n);
+            }
+
+            bool dirty(std::size_t n) const { return dirty_.test(n); }
+
+            bool dirty() const { return dirty_.any(); }
+
+            const mask_type &dirty_mask() const { return dirty_; }
+
+            void checkpoint() { dirty_.reset(); }
+
+            // Patch of the dirty elements with their current values, in index order
+            patch<T> dirty_patch() const
+            {
+                patch<T> ret;
+                for (std::size_t n = 0; n < tuple_size<T>::value; n++) {
+                    if (dirty_.test(n)) {
+                        ret.add(n, value_);
+                    }
+                }
+                return ret;
+            }
+
+            // Like for_each_element_indexed, restricted to the dirty elements
+            template<typename V>
+            void for_each_dirty_element(V &&v) const
+            {
+                for_each_element_indexed(value_, dirty_visitor<V>{dirty_, v});
+            }
+
+        private:
+            friend struct detail::tracked_access;
+
+            template<typename V>
+            struct dirty_visitor
+            {
+                template<typename E, std::size_t I, typename Meta>
+                void operator()(const E &e, std::integral_constant<std::size_t, I> i, Meta meta) const
+                {
+                    if (mask.test(I)) {
+                        v(e, i, meta);
+                    }
+                }
+
+                const mask_type &mask;
+                V &v;
+            };
+
+            T value_;
+            mask_type dirty_;
+        };
+
+        namespace detail {
+            struct tracked_access
+            {
+                // Mutable access to an element, marks it dirty whether or not it's actually modified
+                template<std::size_t I, typename T>
+                static reflected_element_type<I, T> &get(tracked<T> &t)
+                {
+                    t.dirty_.set(I);
+                    return reflected_element<I, T>::get(t.value_);
+                }
+            };
+        } // End of namespace detail
+
+        template<typename T>
+        void set(std::size_t n, tracked<T> &t, const to_variant_t<T> &v)
+        {
+            t.set(n, v);
+        }
+
+        template<typename T>
+        void set(std::size_t n, tracked<T> &t, to_variant_t<T> &&v)
+        {
+            t.set(n, std::move(v));
+        }
+
+        template<typename T>
+        void set(const std::string &key, tracked<T> &t, const to_variant_t<T> &v)
+        {
+            t.set(detail::find_key<T>(key.c_str()), v);
+        }
+
+        template<typename T>
+        void set(const std::string &key, tracked<T> &t, to_variant_t<T> &&v)
+        {
+            t.set(detail::find_key<T>(key.c_str()), std::move(v));
+        }
+
+        template<typename T>
+        to_variant_t<T> get_variant(std::size_t n, const tracked<T> &t)
+        {
+            return get_variant(n, t.value());
+        }
+
+        template<typename T>
+        to_variant_t<T> get_variant(const std::string &key, const tracked<T> &t)
+        {
+            return get_variant(key, t.value());
+        }
+    } // End of namespace cxl::reflection
+    using reflection::tracked;
+    // Brings the tracked<T> overloads into cxl as well
+    using reflection::set;
+    using reflection::get_variant;
+} // End of namespace cxl
+
+namespace std {
+    template<std::size_t I, typename T>
+    std::enable_if_t<!cxl::reflection::reflected_element<I, T>::use_value,
+                     cxl::reflection::reflected_element_type<I, T>> &
+    get(cxl::reflection::tracked<T> &t)
+    {
+        return cxl::reflection::detail::tracked_access::get<I>(t);
+    }
+
+    template<std::size_t I, typename T>
+    decltype(auto) get(const cxl::reflection::tracked<T> &t)
+    {
+        return t.template get<I>();
+    }
+}
+
+#endif // CXL_REFLECTION_TRACKED_HPP
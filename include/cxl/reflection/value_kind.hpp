@@ -0,0 +1,204 @@
+#ifndef CXL_REFLECTION_VALUE_KIND_HPP
+#define CXL_REFLECTION_VALUE_KIND_HPP
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+
+// Classification of value types and element dispatch shared by the serializers
+namespace cxl {
+    namespace reflection {
+        namespace detail {
+            // How a type is written by the text serializers
+            typedef std::integral_constant<int, 0> unsupported_kind;
+            typedef std::integral_constant<int, 1> null_kind;
+            typedef std::integral_constant<int, 2> bool_kind;
+            typedef std::integral_constant<int, 3> integer_kind;
+            typedef std::integral_constant<int, 4> enum_kind;
+            typedef std::integral_constant<int, 5> float_kind;
+            typedef std::integral_constant<int, 6> string_kind;
+            typedef std::integral_constant<int, 7> variant_kind;
+            typedef std::integral_constant<int, 8> tuple_kind;     // tuple, pair and array: JSON arrays
+            typedef std::integral_constant<int, 9> object_kind;    // Other reflectables: JSON objects
+            typedef std::integral_constant<int, 10> map_kind;      // String keyed maps: JSON objects
+            typedef std::integral_constant<int, 11> range_kind;    // Other containers: JSON arrays
+
+            template<typename T>
+            struct is_string : std::false_type
+            {
+            };
+
+            template<typename Traits, typename Allocator>
+            struct is_string<std::basic_string<char, Traits, Allocator>> : std::true_type
+            {
+            };
+
+            template<>
+            struct is_string<const char *> : std::true_type
+            {
+            };
+
+            template<>
+            struct is_string<char *> : std::true_type
+            {
+            };
+
+            template<typename T>
+            struct is_variant : std::false_type
+            {
+            };
+
+            template<typename... T>
+            struct is_variant<cxl::variant<T...>> : std::true_type
+            {
+            };
+
+            template<typename T>
+            struct is_positional : std::false_type
+            {
+            };
+
+            template<typename... T>
+            struct is_positional<std::tuple<T...>> : std::true_type
+            {
+            };
+
+            template<typename T, typename U>
+            struct is_positional<std::pair<T, U>> : std::true_type
+            {
+            };
+
+            template<typename T, std::size_t N>
+            struct is_positional<std::array<T, N>> : std::true_type
+            {
+            };
+
+            template<typename T, typename = void>
+            struct is_range : std::false_type
+            {
+            };
+
+            template<typename T>
+            struct is_range<T, decltype((void) std::begin(std::declval<const T &>()),
+                                        (void) std::end(std::declval<const T &>()))> : std::true_type
+            {
+            };
+
+            template<typename T, typename = void>
+            struct is_string_map : std::false_type
+            {
+            };
+
+            template<typename T>
+            struct is_string_map<T, decltype((void) std::declval<typename T::mapped_type>())>
+                    : is_string<typename T::key_type>
+            {
+            };
+
+            template<typename T>
+            using value_kind = std::integral_constant<
+                    int,
+                    std::is_same<T, std::nullptr_t>::value ? null_kind::value
+                    : std::is_same<T, bool>::value ? bool_kind::value
+                    : std::is_integral<T>::value ? integer_kind::value
+                    : std::is_enum<T>::value ? enum_kind::value
+                    : std::is_floating_point<T>::value ? float_kind::value
+                    : is_string<T>::value ? string_kind::value
+                    : is_variant<T>::value ? variant_kind::value
+                    : is_positional<T>::value ? tuple_kind::value
+                    : reflectable<T> ? object_kind::value
+                    : is_string_map<T>::value ? map_kind::value
+                    : is_range<T>::value ? range_kind::value
+                    : unsupported_kind::value>;
+
+            // Type a container element is parsed into before it's inserted
+            template<typename V>
+            struct parsed_type
+            {
+                typedef V type;
+            };
+
+            // Map entries are parsed with a mutable key
+            template<typename K, typename V>
+            struct parsed_type<std::pair<const K, V>>
+            {
+                typedef std::pair<K, V> type;
+            };
+
+            // How a parser stores into the I-th element of T: in place, through the setter from a
+            // temporary, or not at all as it's readonly and its value is skipped
+            typedef std::integral_constant<int, 0> direct_element;
+            typedef std::integral_constant<int, 1> setter_element;
+            typedef std::integral_constant<int, 2> readonly_element;
+
+            template<std::size_t I, typename T>
+            using element_access = std::integral_constant<int,
+                                                          std::is_const<reflected_element_type<I, T>>::value
+                                                          ? readonly_element::value
+                                                          : reflected_element<I, T>::use_value
+                                                            ? setter_element::value
+                                                            : direct_element::value>;
+
+            template<std::size_t I, typename Reader, typename T, typename... Args>
+            void read_element_as(typename Reader::input_type &in, T &t, direct_element, Args... args)
+            {
+                Reader::read(in, reflected_element<I, T>::get(t), args...);
+            }
+
+            template<std::size_t I, typename Reader, typename T, typename... Args>
+            void read_element_as(typename Reader::input_type &in, T &t, setter_element, Args... args)
+            {
+                std::remove_cv_t<reflected_element_type<I, T>> v{};
+                Reader::read(in, v, args...);
+                reflected_element<I, T>::set(t, std::move(v));
+            }
+
+            template<std::size_t I, typename Reader, typename T, typename... Args>
+            void read_element_as(typename Reader::input_type &in, T &, readonly_element, Args... args)
+            {
+                Reader::skip(in, args...);
+            }
+
+            template<std::size_t I, typename Reader, typename T, typename... Args>
+            void read_element(typename Reader::input_type &in, T &t, Args... args)
+            {
+                read_element_as<I, Reader>(in, t, element_access<I, T>(), args...);
+            }
+
+            /*
+             * Element readers of a parser by element index, for parsers that find elements by key at
+             * runtime. Reader has the parser as input_type, `read(in, v, args...)` to parse a value
+             * into `v` and `skip(in, args...)` to skip one.
+             */
+            template<typename Reader, typename T, typename Seq, typename... Args>
+            struct element_readers;
+
+            template<typename Reader, typename T, std::size_t... I, typename... Args>
+            struct element_readers<Reader, T, std::index_sequence<I...>, Args...>
+            {
+                typedef void (*reader_type)(typename Reader::input_type &, T &, Args...);
+
+                // One extra entry, so an empty T still has an array
+                static constexpr reader_type readers[sizeof...(I) + 1]
+                        = {&read_element<I, Reader, T, Args...>..., nullptr};
+            };
+
+            template<typename Reader, typename T, std::size_t... I, typename... Args>
+            constexpr
+            typename element_readers<Reader, T, std::index_sequence<I...>, Args...>::reader_type
+                    element_readers<Reader, T, std::index_sequence<I...>, Args...>::readers[sizeof...(I) + 1];
+
+            template<typename Reader, typename T, typename... Args>
+            using element_reader_table
+                    = element_readers<Reader, T, std::make_index_sequence<tuple_size<T>::value>, Args...>;
+        } // End of namespace cxl::reflection::detail
+    } // End of namespace cxl::reflection
+} // End of namespace cxl
+
+#endif // CXL_REFLECTION_VALUE_KIND_HPP
@@ -0,0 +1,1434 @@
+#ifndef CXL_REFLECTION_XML_HPP
+#define CXL_REFLECTION_XML_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+#include <type_traits>
+#include <cxl/variant.hpp>
+#include <cxl/reflection/reflection_impl.hpp>
+#include <cxl/reflection/key_index.hpp>
+#include <cxl/reflection/row_binder.hpp>
+#include <cxl/reflection/text_input.hpp>
+#include <cxl/reflection/text_sink.hpp>
+#include <cxl/reflection/value_kind.hpp>
+
+namespace cxl {
+    namespace reflection {
+        namespace xml {
+            // An attribute written on an element's start tag, `name` is written as is
+            struct attribute
+            {
+                const char *name;
+                std::string value;
+            };
+
+            namespace detail {
+                using reflection::detail::find_markup;
+                using reflection::detail::string_sink;
+                using reflection::detail::buffer_sink;
+                using reflection::detail::format_integer;
+                using reflection::detail::format_float;
+                using reflection::detail::unsupported_kind;
+                using reflection::detail::null_kind;
+                using reflection::detail::bool_kind;
+                using reflection::detail::integer_kind;
+                using reflection::detail::enum_kind;
+                using reflection::detail::float_kind;
+                using reflection::detail::string_kind;
+                using reflection::detail::variant_kind;
+                using reflection::detail::tuple_kind;
+                using reflection::detail::object_kind;
+                using reflection::detail::map_kind;
+                using reflection::detail::range_kind;
+                using reflection::detail::value_kind;
+
+                // Names are written unescaped, chars that would break the markup fail at compile time
+                constexpr std::size_t name_size(const char *s)
+                {
+                    std::size_t n = 0;
+                    for (; s[n] != '\0'; n++) {
+                        char c = s[n];
+                        if (c == '<' || c == '>' || c == '&' || c == '"' || c == '\'' || c == '/' || c == '='
+                            || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                            throw std::logic_error("xml: invalid character in name");
+                        }
+                    }
+                    if (n == 0) {
+                        throw std::logic_error("xml: empty name");
+                    }
+                    return n;
+                }
+
+                // Length of `ns:node`, or `node` without a namespace
+                constexpr std::size_t qualified_size(const char *ns, const char *node)
+                {
+                    return (ns[0] != '\0' ? name_size(ns) + 1 : 0) + name_size(node);
+                }
+
+                template<std::size_t N>
+                struct fragment
+                {
+                    char data[N];
+                };
+
+                // `<ns:node>`, or `</ns:node>` if `close`
+                template<std::size_t N>
+                constexpr fragment<N> make_tag(const char *ns, const char *node, bool close)
+                {
+                    fragment<N> f{};
+                    std::size_t n = 0;
+                    f.data[n++] = '<';
+                    if (close) {
+                        f.data[n++] = '/';
+                    }
+                    if (ns[0] != '\0') {
+                        for (; *ns != '\0'; ++ns) {
+                            f.data[n++] = *ns;
+                        }
+                        f.data[n++] = ':';
+                    }
+                    for (; *node != '\0'; ++node) {
+                        f.data[n++] = *node;
+                    }
+                    f.data[n++] = '>';
+                    return f;
+                }
+
+                // Element name of the I-th element of T
+                template<std::size_t I, typename T>
+                struct element_name
+                {
+                    static constexpr const char *ns()
+                    {
+                        return reflection::detail::get_xml_namespace<I, T>();
+                    }
+
+                    static constexpr const char *node() { return reflection::detail::get_xml_node<I, T>(); }
+                };
+
+                // Element name of a T written as a whole
+                template<typename T>
+                struct type_name
+                {
+                    static constexpr const char *ns() { return get_xml_namespace<T>(); }
+
+                    static constexpr const char *node() { return get_xml_node<T>(); }
+                };
+
+                // Start and end tags of Name, with the namespace prefix, built at compile time
+                template<typename Name>
+                struct tags
+                {
+                    static constexpr std::size_t size = qualified_size(Name::ns(), Name::node());
+                    static constexpr fragment<size + 2> open
+                            = make_tag<size + 2>(Name::ns(), Name::node(), false);
+                    static constexpr fragment<size + 3> close
+                            = make_tag<size + 3>(Name::ns(), Name::node(), true);
+                };
+
+                template<typename Name>
+                constexpr fragment<tags<Name>::size + 2> tags<Name>::open;
+
+                template<typename Name>
+                constexpr fragment<tags<Name>::size + 3> tags<Name>::close;
+
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, const T &t);
+
+                /*
+                 * Text content, or an attribute value if `attribute`. Clean runs are found by
+                 * find_markup and appended as a whole. Control chars other than tab, LF and CR
+                 * cannot appear in XML 1.0 and throw.
+                 */
+                template<typename Sink>
+                void write_text(Sink &sink, const char *s, std::size_t n, bool attribute)
+                {
+                    const char *end = s + n;
+                    while (s != end) {
+                        const char *run = s;
+                        s = find_markup(s, end);
+                        sink.append(run, std::size_t(s - run));
+                        if (s == end) {
+                            break;
+                        }
+                        char c = *s++;
+                        switch (c) {
+                            case '<':
+                                sink.append("&lt;", 4);
+                                break;
+                            case '>':
+                                sink.append("&gt;", 4);
+                                break;
+                            case '&':
+                                sink.append("&amp;", 5);
+                                break;
+                            case '"':
+                                if (attribute) {
+                                    sink.append("&quot;", 6);
+                                } else {
+                                    sink.put(c);
+                                }
+                                break;
+                            // Parsers normalize CR to LF, and whitespace in attribute values to spaces
+                            case '\r':
+                                sink.append("&#13;", 5);
+                                break;
+                            case '\n':
+                                if (attribute) {
+                                    sink.append("&#10;", 5);
+                                } else {
+                                    sink.put(c);
+                                }
+                                break;
+                            case '\t':
+                                if (attribute) {
+                                    sink.append("&#9;", 4);
+                                } else {
+                                    sink.put(c);
+                                }
+                                break;
+                            default:
+                                throw std::invalid_argument("xml: control character in text");
+                        }
+                    }
+                }
+
+                template<typename Sink>
+                void write_attributes(Sink &sink, std::initializer_list<attribute> attributes)
+                {
+                    for (const attribute &a : attributes) {
+                        sink.put(' ');
+                        sink.append(a.name, std::strlen(a.name));
+                        sink.append("=\"", 2);
+                        write_text(sink, a.value.data(), a.value.size(), true);
+                        sink.put('"');
+                    }
+                }
+
+                // null is an empty element
+                template<typename Sink>
+                void write_content(Sink &, std::nullptr_t, null_kind)
+                {
+                }
+
+                template<typename Sink>
+                void write_content(Sink &sink, bool t, bool_kind)
+                {
+                    if (t) {
+                        sink.append("true", 4);
+                    } else {
+                        sink.append("false", 5);
+                    }
+                }
+
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, T t, integer_kind)
+                {
+                    char buf[24];
+                    char *p = format_integer(t, buf + sizeof(buf));
+                    sink.append(p, std::size_t(buf + sizeof(buf) - p));
+                }
+
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, T t, enum_kind)
+                {
+                    write_content(sink, static_cast<std::underlying_type_t<T>>(t), integer_kind());
+                }
+
+                // NaN and infinities as in xsd:double
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, T t, float_kind)
+                {
+                    if (std::isnan(t)) {
+                        sink.append("NaN", 3);
+                    } else if (std::isinf(t)) {
+                        if (t < 0) {
+                            sink.append("-INF", 4);
+                        } else {
+                            sink.append("INF", 3);
+                        }
+                    } else {
+                        char buf[48];
+                        sink.append(buf, format_float(t, buf));
+                    }
+                }
+
+                template<typename Sink, typename Traits, typename Allocator>
+                void write_content(Sink &sink,
+                                   const std::basic_string<char, Traits, Allocator> &t,
+                                   string_kind)
+                {
+                    write_text(sink, t.data(), t.size(), false);
+                }
+
+                template<typename Sink>
+                void write_content(Sink &sink, const char *t, string_kind)
+                {
+                    if (t != nullptr) {
+                        write_text(sink, t, std::strlen(t), false);
+                    }
+                }
+
+                template<typename Sink>
+                struct variant_writer
+                {
+                    template<typename U>
+                    void operator()(const U &u) const
+                    {
+                        write_content(sink, u);
+                    }
+
+                    Sink &sink;
+                };
+
+                // The current alternative, whose index is on the start tag; an empty variant is empty
+                template<typename Sink, typename... U>
+                void write_content(Sink &sink, const cxl::variant<U...> &t, variant_kind)
+                {
+                    if (t.which() < sizeof...(U)) {
+                        t.apply_visitor(variant_writer<Sink>{sink});
+                    }
+                }
+
+                // Writes the last `n` characters of the start tag of the element holding `t`, `tail`
+                // ending with its '>'
+                template<typename Sink, typename T>
+                void end_start_tag(Sink &sink, const char *tail, std::size_t n, const T &)
+                {
+                    sink.append(tail, n);
+                }
+
+                // Text has no type, so a variant's start tag gets a which="N" attribute naming the
+                // alternative that's held
+                template<typename Sink, typename... U>
+                void end_start_tag(Sink &sink, const char *tail, std::size_t n, const cxl::variant<U...> &t)
+                {
+                    sink.append(tail, n - 1);
+                    if (t.which() < sizeof...(U)) {
+                        sink.append(" which=\"", 8);
+                        write_content(sink, t.which(), integer_kind());
+                        sink.put('"');
+                    }
+                    sink.put('>');
+                }
+
+                // Elements without a name, positional and container elements, are <item>s
+                template<typename Sink, typename T>
+                void write_item(Sink &sink, const T &t)
+                {
+                    end_start_tag(sink, "<item>", 6, t);
+                    write_content(sink, t);
+                    sink.append("</item>", 7);
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void write_elements(Sink &sink, const T &t, std::index_sequence<I...>, tuple_kind)
+                {
+                    typedef int expander[];
+                    (void) expander{0, (write_item(sink, reflected_element<I, T>::get(t)), 0)...};
+                }
+
+                template<std::size_t I, typename Sink, typename T>
+                void write_member(Sink &sink, const T &t)
+                {
+                    typedef tags<element_name<I, T>> member_tags;
+                    const auto &v = reflected_element<I, T>::get(t);
+                    end_start_tag(sink, member_tags::open.data, member_tags::size + 2, v);
+                    write_content(sink, v);
+                    sink.append(member_tags::close.data, member_tags::size + 3);
+                }
+
+                template<typename Sink, typename T, std::size_t... I>
+                void write_elements(Sink &sink, const T &t, std::index_sequence<I...>, object_kind)
+                {
+                    typedef int expander[];
+                    (void) expander{0, (write_member<I>(sink, t), 0)...};
+                }
+
+                template<typename Sink, typename T, typename Kind>
+                std::enable_if_t<Kind::value == tuple_kind::value || Kind::value == object_kind::value>
+                write_content(Sink &sink, const T &t, Kind kind)
+                {
+                    write_elements(sink, t, std::make_index_sequence<tuple_size<T>::value>(), kind);
+                }
+
+                // Keys may not be valid names, entries are <entry key="...">
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, const T &t, map_kind)
+                {
+                    for (const auto &e : t) {
+                        sink.append("<entry key=\"", 12);
+                        write_text(sink, e.first.data(), e.first.size(), true);
+                        end_start_tag(sink, "\">", 2, e.second);
+                        write_content(sink, e.second);
+                        sink.append("</entry>", 8);
+                    }
+                }
+
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, const T &t, range_kind)
+                {
+                    for (const auto &e : t) {
+                        write_item(sink, e);
+                    }
+                }
+
+                template<typename Sink, typename T>
+                void write_content(Sink &sink, const T &t)
+                {
+                    static_assert(value_kind<uncv<T>>::value != unsupported_kind::value,
+                                  "Type cannot be written as XML");
+                    write_content(sink, t, value_kind<uncv<T>>());
+                }
+
+                // `t` as an element named by get_xml_node<T>() and get_xml_namespace<T>()
+                template<typename Sink, typename T>
+                void write_element(Sink &sink, const T &t, std::initializer_list<attribute> attributes)
+                {
+                    static_assert(value_kind<T>::value == object_kind::value,
+                                  "Only reflectables other than tuple, pair and array have an element name");
+                    typedef tags<type_name<T>> type_tags;
+                    // The start tag without its '>'
+                    sink.append(type_tags::open.data, type_tags::size + 1);
+                    write_attributes(sink, attributes);
+                    sink.put('>');
+                    write_content(sink, t);
+                    sink.append(type_tags::close.data, type_tags::size + 3);
+                }
+            }   // End of namespace detail
+
+            /**
+             * Buffered XML output to a streambuf, no document is built. A reflectable type is written
+             * as an element named by get_xml_node<T>(), each of its elements as a child named by
+             * get_element_xml_node(), prefixed by the xml_namespace() if there is one. Start and end
+             * tags are constant fragments built at compile time.
+             *
+             * std::tuple/pair/array and containers are written as a sequence of <item>s, string keyed
+             * maps as <entry key="..."> and cxl::variant as its current alternative, with its index in
+             * a which="N" attribute of the enclosing start tag. Namespace prefixes are not declared,
+             * pass the xmlns attributes to open() or write().
+             */
+            class writer
+            {
+            public:
+                static constexpr std::size_t default_buffer_size = 1 << 16;
+
+                writer(std::streambuf &sb, char *buffer, std::size_t size) : sink_(sb, buffer, size) { }
+
+                explicit writer(std::streambuf &sb)
+                        : own_(new char[default_buffer_size]), sink_(sb, own_.get(), default_buffer_size)
+                {
+                }
+
+                writer(const writer &) = delete;
+
+                writer &operator=(const writer &) = delete;
+
+                // Flushes, elements that are still open are left open
+                ~writer()
+                {
+                    try {
+                        sink_.flush();
+                    } catch (...) {
+                    }
+                }
+
+                void declaration() { sink_.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", 39); }
+
+                // Starts an element that encloses what follows, until the matching close()
+                void open(const std::string &name, std::initializer_list<attribute> attributes = {})
+                {
+                    sink_.put('<');
+                    sink_.append(name.data(), name.size());
+                    detail::write_attributes(sink_, attributes);
+                    sink_.put('>');
+                    open_.push_back(name);
+                }
+
+                void close()
+                {
+                    if (open_.empty()) {
+                        throw std::logic_error("xml: no open element");
+                    }
+                    sink_.append("</", 2);
+                    sink_.append(open_.back().data(), open_.back().size());
+                    sink_.put('>');
+                    open_.pop_back();
+                }
+
+                template<typename T>
+                void write(const T &t, std::initializer_list<attribute> attributes = {})
+                {
+                    detail::write_element(sink_, t, attributes);
+                }
+
+                // Raw text between elements, e.g. '\n'
+                void put(char c) { sink_.put(c); }
+
+                void flush() { sink_.flush(); }
+
+                // Bytes written so far, including the ones still in the buffer
+                std::size_t size() const { return sink_.size(); }
+
+            private:
+                std::unique_ptr<char[]> own_;
+                detail::buffer_sink sink_;
+                std::vector<std::string> open_;
+            };
+
+            // Appends `t` as an element to `out`
+            template<typename T>
+            void write_xml(std::string &out, const T &t, std::initializer_list<attribute> attributes = {})
+            {
+                detail::string_sink sink{out};
+                detail::write_element(sink, t, attributes);
+            }
+
+            template<typename T>
+            std::string to_xml(const T &t, std::initializer_list<attribute> attributes = {})
+            {
+                std::string ret;
+                write_xml(ret, t, attributes);
+                return ret;
+            }
+
+            // Returns the number of bytes written
+            template<typename T>
+            std::size_t write_xml(std::streambuf &sb,
+                                  const T &t,
+                                  std::initializer_list<attribute> attributes = {})
+            {
+                writer w(sb);
+                w.write(t, attributes);
+                w.flush();
+                return w.size();
+            }
+
+            namespace detail {
+                using reflection::detail::find_either;
+                using reflection::detail::scan_result;
+                using reflection::detail::input;
+                using reflection::detail::parsed_type;
+
+                // The qualified names of T's elements, for key_index
+                template<typename T, typename Seq = std::make_index_sequence<tuple_size<T>::value>>
+                struct xml_names;
+
+                template<typename T, std::size_t... I>
+                struct xml_names<T, std::index_sequence<I...>>
+                {
+                    static constexpr std::size_t size = sizeof...(I);
+                    // Past the '<' of the start tags, not terminated
+                    static constexpr const char *names[sizeof...(I) + 1]
+                            = {(tags<element_name<I, T>>::open.data + 1)..., ""};
+                    static constexpr std::size_t sizes[sizeof...(I) + 1]
+                            = {tags<element_name<I, T>>::size..., 0};
+
+                    static constexpr const char *key(std::size_t i) { return names[i]; }
+
+                    static constexpr std::size_t length(std::size_t i) { return sizes[i]; }
+                };
+
+                template<typename T, std::size_t... I>
+                constexpr const char *xml_names<T, std::index_sequence<I...>>::names[sizeof...(I) + 1];
+
+                template<typename T, std::size_t... I>
+                constexpr std::size_t xml_names<T, std::index_sequence<I...>>::sizes[sizeof...(I) + 1];
+
+                // Perfect hash of the qualified names of T's elements
+                template<typename T>
+                using name_index = reflection::detail::key_index<xml_names<T>>;
+
+                inline bool is_space(char c)
+                {
+                    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+                }
+
+                // End of the name that starts at `p`
+                inline const char *name_end(const char *p, const char *end)
+                {
+                    while (p != end && !is_space(*p) && *p != '>' && *p != '/' && *p != '=') {
+                        ++p;
+                    }
+                    return p;
+                }
+
+                // Past the first `s` (of size n > 0) in [p, end), nullptr if there is none
+                inline const char *find_terminator(const char *p,
+                                                   const char *end,
+                                                   const char *s,
+                                                   std::size_t n)
+                {
+                    for (p += n - 1; p < end; ++p) {
+                        const void *found = std::memchr(p, s[n - 1], std::size_t(end - p));
+                        if (found == nullptr) {
+                            return nullptr;
+                        }
+                        p = static_cast<const char *>(found);
+                        if (std::memcmp(p - (n - 1), s, n - 1) == 0) {
+                            return p + 1;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                // The closing quote matching the one at `q`, nullptr if there is none before `end`
+                inline const char *quote_end(const char *q, const char *end)
+                {
+                    return static_cast<const char *>(std::memchr(q + 1, *q, std::size_t(end - q - 1)));
+                }
+
+                enum class markup
+                {
+                    start_tag, empty_tag, end_tag, other
+                };
+
+                /*
+                 * Past the end of the tag, comment, CDATA section, processing instruction or DOCTYPE
+                 * that starts at the '<' at `p`, nullptr if it does not end before `end`. Quoted
+                 * attribute values may contain '>'.
+                 */
+                inline const char *markup_end(const char *p, const char *end, markup &kind)
+                {
+                    const char *q = p + 1;
+                    if (q == end) {
+                        return nullptr;
+                    }
+                    kind = markup::other;
+                    if (*q == '?') {
+                        return find_terminator(q + 1, end, "?>", 2);
+                    }
+                    if (*q == '!') {
+                        if (end - p < 4) {
+                            return nullptr;
+                        }
+                        if (std::memcmp(p, "<!--", 4) == 0) {
+                            return find_terminator(p + 4, end, "-->", 3);
+                        }
+                        if (end - p < 9) {
+                            return nullptr;
+                        }
+                        if (std::memcmp(p, "<![CDATA[", 9) == 0) {
+                            return find_terminator(p + 9, end, "]]>", 3);
+                        }
+                        // A DOCTYPE, its internal subset is in brackets
+                        std::size_t depth = 0;
+                        for (++q; q != end; ++q) {
+                            char c = *q;
+                            if (c == '"' || c == '\'') {
+                                q = quote_end(q, end);
+                                if (q == nullptr) {
+                                    return nullptr;
+                                }
+                            } else if (c == '[') {
+                                ++depth;
+                            } else if (c == ']' && depth > 0) {
+                                --depth;
+                            } else if (c == '>' && depth == 0) {
+                                return q + 1;
+                            }
+                        }
+                        return nullptr;
+                    }
+                    if (*q == '/') {
+                        kind = markup::end_tag;
+                        q = static_cast<const char *>(std::memchr(q, '>', std::size_t(end - q)));
+                        return q != nullptr ? q + 1 : nullptr;
+                    }
+                    for (; q != end; ++q) {
+                        char c = *q;
+                        if (c == '"' || c == '\'') {
+                            q = quote_end(q, end);
+                            if (q == nullptr) {
+                                return nullptr;
+                            }
+                        } else if (c == '>') {
+                            kind = q[-1] == '/' ? markup::empty_tag : markup::start_tag;
+                            return q + 1;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                inline void append_utf8(std::string &out, unsigned long cp)
+                {
+                    if (cp < 0x80) {
+                        out.push_back(char(cp));
+                    } else if (cp < 0x800) {
+                        out.push_back(char(0xC0 | (cp >> 6)));
+                        out.push_back(char(0x80 | (cp & 0x3F)));
+                    } else if (cp < 0x10000) {
+                        out.push_back(char(0xE0 | (cp >> 12)));
+                        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(char(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back(char(0xF0 | (cp >> 18)));
+                        out.push_back(char(0x80 | ((cp >> 12) & 0x3F)));
+                        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(char(0x80 | (cp & 0x3F)));
+                    }
+                }
+
+                // A start tag, `key` is the value of its "key" attribute if it has one, `which` the value
+                // of its "which" attribute or no_which
+                struct element
+                {
+                    const char *name;
+                    std::size_t size;
+                    bool empty;
+                    bool has_key;
+                    std::size_t which;
+                };
+
+                constexpr std::size_t no_which = std::size_t(-1);
+
+                class parser;
+
+                struct element_reader;
+
+                // Element parsers by element index, given the start tag of the element
+                template<typename T>
+                using element_parsers
+                        = reflection::detail::element_reader_table<element_reader, T, const element &>;
+
+                /**
+                 * Recursive descent over XML text in memory, straight into the target values: child
+                 * elements of a reflectable are matched by qualified name, text content is parsed into
+                 * scalars, nothing is kept once it's been read. Malformed markup and values that don't
+                 * fit their target throw std::invalid_argument.
+                 */
+                class parser
+                {
+                public:
+                    parser(const char *begin, const char *end) : begin_(begin), p_(begin), end_(end) { }
+
+                    // The root element, which must be named like T
+                    template<typename T>
+                    void parse_root(T &t)
+                    {
+                        static_assert(value_kind<T>::value == object_kind::value,
+                                      "Only reflectables other than tuple, pair and array are elements");
+                        typedef tags<type_name<T>> type_tags;
+                        skip_misc();
+                        if (!at('<')) {
+                            fail("expected the root element");
+                        }
+                        element e;
+                        start_tag(e, nullptr);
+                        if (e.size != type_tags::size
+                            || std::memcmp(e.name, type_tags::open.data + 1, e.size) != 0) {
+                            fail("unexpected root element");
+                        }
+                        parse(t, e);
+                    }
+
+                    // The content and end tag of `e`, whose start tag was just read
+                    template<typename T>
+                    void parse(T &t, const element &e)
+                    {
+                        static_assert(value_kind<T>::value != unsupported_kind::value
+                                      && !std::is_pointer<T>::value, "Type cannot be parsed from XML");
+                        parse_value(t, e, value_kind<T>());
+                    }
+
+                    // Skips the content and end tag of `e`, only checking what's needed to find its end
+                    void skip_content(const element &e)
+                    {
+                        std::size_t depth = e.empty ? 0 : 1;
+                        while (depth > 0) {
+                            const void *found = std::memchr(p_, '<', std::size_t(end_ - p_));
+                            if (found == nullptr) {
+                                p_ = end_;
+                                fail("unterminated element");
+                            }
+                            p_ = static_cast<const char *>(found);
+                            markup kind;
+                            const char *q = markup_end(p_, end_, kind);
+                            if (q == nullptr) {
+                                fail("unterminated markup");
+                            }
+                            depth += kind == markup::start_tag ? 1 : 0;
+                            depth -= kind == markup::end_tag ? 1 : 0;
+                            p_ = q;
+                        }
+                    }
+
+                    // Only whitespace, comments and processing instructions may follow
+                    void finish()
+                    {
+                        skip_misc();
+                        if (p_ != end_) {
+                            fail("unexpected content after the root element");
+                        }
+                    }
+
+                    const char *position() const { return p_; }
+
+                    [[noreturn]] void fail(const char *what) const
+                    {
+                        throw std::invalid_argument(std::string("xml: ") + what + " at offset "
+                                                    + std::to_string(p_ - begin_));
+                    }
+
+                private:
+                    bool at(char c) const { return p_ != end_ && *p_ == c; }
+
+                    void skip_ws()
+                    {
+                        while (p_ != end_ && is_space(*p_)) {
+                            ++p_;
+                        }
+                    }
+
+                    // Whitespace, XML declaration, comments, processing instructions and DOCTYPE
+                    void skip_misc()
+                    {
+                        for (;;) {
+                            skip_ws();
+                            if (end_ - p_ < 2 || p_[0] != '<' || (p_[1] != '?' && p_[1] != '!')) {
+                                return;
+                            }
+                            markup kind;
+                            const char *q = markup_end(p_, end_, kind);
+                            if (q == nullptr) {
+                                fail("unterminated markup");
+                            }
+                            p_ = q;
+                        }
+                    }
+
+                    // One reference at the '&' at p_, appended to `out`
+                    void reference(std::string &out)
+                    {
+                        const char *start = ++p_;
+                        // The longest reference is "&#x10FFFF;"
+                        std::size_t limit = std::size_t(std::min<std::ptrdiff_t>(end_ - p_, 12));
+                        const void *found = std::memchr(p_, ';', limit);
+                        if (found == nullptr) {
+                            fail("invalid reference");
+                        }
+                        const char *semi = static_cast<const char *>(found);
+                        std::size_t n = std::size_t(semi - start);
+                        p_ = semi + 1;
+                        if (n == 2 && std::memcmp(start, "lt", 2) == 0) {
+                            out.push_back('<');
+                        } else if (n == 2 && std::memcmp(start, "gt", 2) == 0) {
+                            out.push_back('>');
+                        } else if (n == 3 && std::memcmp(start, "amp", 3) == 0) {
+                            out.push_back('&');
+                        } else if (n == 4 && std::memcmp(start, "quot", 4) == 0) {
+                            out.push_back('"');
+                        } else if (n == 4 && std::memcmp(start, "apos", 4) == 0) {
+                            out.push_back('\'');
+                        } else if (n >= 2 && *start == '#') {
+                            bool hex = start[1] == 'x';
+                            unsigned long cp = 0;
+                            const char *d = start + (hex ? 2 : 1);
+                            if (d == semi) {
+                                fail("invalid character reference");
+                            }
+                            for (; d != semi; ++d) {
+                                int v = *d >= '0' && *d <= '9' ? *d - '0'
+                                        : hex && *d >= 'a' && *d <= 'f' ? *d - 'a' + 10
+                                        : hex && *d >= 'A' && *d <= 'F' ? *d - 'A' + 10 : -1;
+                                if (v < 0) {
+                                    fail("invalid character reference");
+                                }
+                                cp = cp * (hex ? 16 : 10) + unsigned(v);
+                            }
+                            if (cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000)) {
+                                fail("invalid character reference");
+                            }
+                            append_utf8(out, cp);
+                        } else {
+                            p_ = start - 1;
+                            fail("unknown entity");
+                        }
+                    }
+
+                    // The start tag at the '<' at p_. The "key" attribute is decoded into `key` if
+                    // `key` isn't null, the "which" attribute into e.which, other attributes are skipped.
+                    void start_tag(element &e, std::string *key)
+                    {
+                        ++p_;
+                        e.name = p_;
+                        p_ = name_end(p_, end_);
+                        e.size = std::size_t(p_ - e.name);
+                        e.has_key = false;
+                        e.which = no_which;
+                        if (e.size == 0) {
+                            fail("expected an element name");
+                        }
+                        for (;;) {
+                            skip_ws();
+                            if (at('>')) {
+                                ++p_;
+                                e.empty = false;
+                                return;
+                            }
+                            if (at('/')) {
+                                ++p_;
+                                if (!at('>')) {
+                                    fail("expected '>'");
+                                }
+                                ++p_;
+                                e.empty = true;
+                                return;
+                            }
+                            const char *name = p_;
+                            p_ = name_end(p_, end_);
+                            bool is_key = key != nullptr && p_ - name == 3
+                                          && std::memcmp(name, "key", 3) == 0;
+                            bool is_which = p_ - name == 5 && std::memcmp(name, "which", 5) == 0;
+                            skip_ws();
+                            if (name == p_ || !at('=')) {
+                                fail("expected an attribute");
+                            }
+                            ++p_;
+                            skip_ws();
+                            if (!at('"') && !at('\'')) {
+                                fail("expected a quoted attribute value");
+                            }
+                            char quote = *p_++;
+                            const void *found = std::memchr(p_, quote, std::size_t(end_ - p_));
+                            if (found == nullptr) {
+                                fail("unterminated attribute value");
+                            }
+                            const char *close = static_cast<const char *>(found);
+                            if (is_key) {
+                                key->clear();
+                                while (p_ != close) {
+                                    const char *run = p_;
+                                    p_ = find_either(p_, close, '&', '<');
+                                    key->append(run, std::size_t(p_ - run));
+                                    if (at('<')) {
+                                        fail("'<' in attribute value");
+                                    }
+                                    if (p_ != close) {
+                                        reference(*key);
+                                    }
+                                }
+                                e.has_key = true;
+                            } else if (is_which
+                                       && (!reflection::detail::parse_text(p_, close, e.which)
+                                           || e.which == no_which)) {
+                                fail("invalid which attribute");
+                            }
+                            p_ = close + 1;
+                        }
+                    }
+
+                    // The end tag at the "</" at p_, which must close `e`
+                    void end_tag(const element &e)
+                    {
+                        p_ += 2;
+                        const char *name = p_;
+                        p_ = name_end(p_, end_);
+                        if (std::size_t(p_ - name) != e.size || std::memcmp(name, e.name, e.size) != 0) {
+                            p_ = name;
+                            fail("mismatched end tag");
+                        }
+                        skip_ws();
+                        if (!at('>')) {
+                            fail("expected '>'");
+                        }
+                        ++p_;
+                    }
+
+                    // Reads up to the next child of `parent` and returns true, or consumes the end tag
+                    // of `parent` and returns false. Text between children is ignored.
+                    bool next_child(element &child, const element &parent, std::string *key)
+                    {
+                        if (parent.empty) {
+                            return false;
+                        }
+                        for (;;) {
+                            const void *found = std::memchr(p_, '<', std::size_t(end_ - p_));
+                            if (found == nullptr) {
+                                p_ = end_;
+                                fail("unterminated element");
+                            }
+                            p_ = static_cast<const char *>(found);
+                            if (end_ - p_ < 2) {
+                                fail("unterminated element");
+                            }
+                            if (p_[1] == '/') {
+                                end_tag(parent);
+                                return false;
+                            }
+                            if (p_[1] == '!' || p_[1] == '?') {
+                                markup kind;
+                                const char *q = markup_end(p_, end_, kind);
+                                if (q == nullptr) {
+                                    fail("unterminated markup");
+                                }
+                                p_ = q;
+                                continue;
+                            }
+                            start_tag(child, key);
+                            return true;
+                        }
+                    }
+
+                    // Appends raw text with its line ends normalized: CRLF and lone CRs are LFs
+                    static void append_text(std::string &out, const char *s, std::size_t n)
+                    {
+                        const char *end = s + n;
+                        for (;;) {
+                            const void *cr_at = std::memchr(s, '\r', std::size_t(end - s));
+                            const char *cr = static_cast<const char *>(cr_at);
+                            if (cr == nullptr) {
+                                out.append(s, std::size_t(end - s));
+                                return;
+                            }
+                            out.append(s, std::size_t(cr - s));
+                            out.push_back('\n');
+                            s = cr + 1 != end && cr[1] == '\n' ? cr + 2 : cr + 1;
+                        }
+                    }
+
+                    /*
+                     * Text content of `e` up to its end tag, with references and CDATA sections
+                     * decoded and line ends normalized. Points into the input unless it has any, child
+                     * elements throw.
+                     */
+                    void read_text(const element &e, const char *&text, std::size_t &n)
+                    {
+                        text = p_;
+                        n = 0;
+                        if (e.empty) {
+                            return;
+                        }
+                        const char *q = find_either(p_, end_, '<', '&');
+                        if (end_ - q >= 2 && q[0] == '<' && q[1] == '/'
+                            && std::memchr(p_, '\r', std::size_t(q - p_)) == nullptr) {
+                            n = std::size_t(q - p_);
+                            p_ = q;
+                            end_tag(e);
+                            return;
+                        }
+                        text_.clear();
+                        for (;;) {
+                            const char *run = p_;
+                            p_ = find_either(p_, end_, '<', '&');
+                            append_text(text_, run, std::size_t(p_ - run));
+                            if (p_ == end_ || end_ - p_ < 2) {
+                                p_ = end_;
+                                fail("unterminated element");
+                            }
+                            if (*p_ == '&') {
+                                reference(text_);
+                                continue;
+                            }
+                            if (p_[1] == '/') {
+                                end_tag(e);
+                                break;
+                            }
+                            markup kind;
+                            const char *close = markup_end(p_, end_, kind);
+                            if (close == nullptr) {
+                                fail("unterminated markup");
+                            }
+                            if (kind != markup::other) {
+                                fail("unexpected element in text content");
+                            }
+                            if (end_ - p_ >= 9 && std::memcmp(p_, "<![CDATA[", 9) == 0) {
+                                append_text(text_, p_ + 9, std::size_t(close - 3 - (p_ + 9)));
+                            }
+                            p_ = close;
+                        }
+                        text = text_.data();
+                        n = text_.size();
+                    }
+
+                    // Text content without surrounding whitespace, for scalars
+                    void scalar_text(const element &e, const char *&text, const char *&end)
+                    {
+                        std::size_t n;
+                        read_text(e, text, n);
+                        end = text + n;
+                        while (text != end && is_space(*text)) {
+                            ++text;
+                        }
+                        while (end != text && is_space(end[-1])) {
+                            --end;
+                        }
+                    }
+
+                    template<typename T>
+                    void parse_scalar(T &t, const element &e)
+                    {
+                        const char *text;
+                        const char *end;
+                        scalar_text(e, text, end);
+                        if (!reflection::detail::parse_text(text, end, t)) {
+                            fail("invalid value");
+                        }
+                    }
+
+                    void parse_value(std::nullptr_t &, const element &e, null_kind)
+                    {
+                        skip_content(e);
+                    }
+
+                    void parse_value(bool &t, const element &e, bool_kind)
+                    {
+                        parse_scalar(t, e);
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, const element &e, integer_kind)
+                    {
+                        parse_scalar(t, e);
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, const element &e, enum_kind)
+                    {
+                        std::underlying_type_t<T> v;
+                        parse_scalar(v, e);
+                        t = static_cast<T>(v);
+                    }
+
+                    // The lexical forms of xsd:double: decimals, NaN, INF and -INF
+                    template<typename T>
+                    void parse_value(T &t, const element &e, float_kind)
+                    {
+                        const char *text;
+                        const char *end;
+                        scalar_text(e, text, end);
+                        std::size_t n = std::size_t(end - text);
+                        if (n == 3 && std::memcmp(text, "NaN", 3) == 0) {
+                            t = std::numeric_limits<T>::quiet_NaN();
+                        } else if (n == 3 && std::memcmp(text, "INF", 3) == 0) {
+                            t = std::numeric_limits<T>::infinity();
+                        } else if (n == 4 && std::memcmp(text, "-INF", 4) == 0) {
+                            t = -std::numeric_limits<T>::infinity();
+                        } else if (!reflection::detail::is_decimal(text, end)
+                                   || !reflection::detail::parse_text(text, end, t)) {
+                            fail("invalid value");
+                        }
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, const element &e, string_kind)
+                    {
+                        const char *text;
+                        std::size_t n;
+                        read_text(e, text, n);
+                        t.assign(text, n);
+                    }
+
+                    template<typename U, typename V>
+                    bool parse_alternative(V &v, const element &e, const char *start)
+                    {
+                        typedef unwrap_type<U> A;
+                        p_ = start;
+                        try {
+                            A a{};
+                            parse(a, e);
+                            v = std::move(a);
+                            return true;
+                        } catch (std::invalid_argument &) {
+                            return false;
+                        }
+                    }
+
+                    // The alternative named by the which attribute; the attribute belongs to this variant,
+                    // variants nested in the alternative don't see it
+                    template<typename U, typename V>
+                    static void parse_which(parser &in, V &v, const element &e)
+                    {
+                        element inner = e;
+                        inner.which = no_which;
+                        unwrap_type<U> a{};
+                        in.parse(a, inner);
+                        v = std::move(a);
+                    }
+
+                    // The alternative named by the which attribute the writer puts on the start tag.
+                    // Without one, alternatives are tried in order and the first that parses is kept.
+                    template<typename... U>
+                    void parse_value(cxl::variant<U...> &t, const element &e, variant_kind)
+                    {
+                        if (e.which != no_which) {
+                            if (e.which >= sizeof...(U)) {
+                                fail("invalid which attribute");
+                            }
+                            typedef cxl::variant<U...> V;
+                            typedef void (*reader_type)(parser &, V &, const element &);
+                            static constexpr reader_type readers[] = {&parser::parse_which<U, V>...};
+                            readers[e.which](*this, t, e);
+                            return;
+                        }
+                        const char *start = p_;
+                        bool done = false;
+                        typedef int expander[];
+                        (void) expander{0, (done = done || parse_alternative<U>(t, e, start), 0)...};
+                        if (!done) {
+                            p_ = start;
+                            fail("no alternative of the variant matches");
+                        }
+                    }
+
+                    // Children are the elements in order, whatever their names
+                    template<typename T>
+                    void parse_value(T &t, const element &e, tuple_kind)
+                    {
+                        element child;
+                        for (std::size_t i = 0; next_child(child, e, nullptr); i++) {
+                            if (i == tuple_size<T>::value) {
+                                fail("too many items");
+                            }
+                            element_parsers<T>::readers[i](*this, t, child);
+                        }
+                    }
+
+                    // Elements missing from the content are left untouched, unknown children are skipped
+                    template<typename T>
+                    void parse_value(T &t, const element &e, object_kind)
+                    {
+                        element child;
+                        while (next_child(child, e, nullptr)) {
+                            std::size_t i = name_index<T>::find(child.name, child.size);
+                            if (i < tuple_size<T>::value) {
+                                element_parsers<T>::readers[i](*this, t, child);
+                            } else {
+                                skip_content(child);
+                            }
+                        }
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, const element &e, map_kind)
+                    {
+                        t.clear();
+                        element child;
+                        std::string key;
+                        while (next_child(child, e, &key)) {
+                            if (!child.has_key) {
+                                fail("expected a key attribute");
+                            }
+                            typename T::mapped_type value{};
+                            parse(value, child);
+                            t.emplace(typename T::key_type(key), std::move(value));
+                        }
+                    }
+
+                    template<typename T>
+                    void parse_value(T &t, const element &e, range_kind)
+                    {
+                        t.clear();
+                        element child;
+                        while (next_child(child, e, nullptr)) {
+                            typename parsed_type<typename T::value_type>::type value{};
+                            parse(value, child);
+                            t.insert(t.end(), std::move(value));
+                        }
+                    }
+
+                    const char *begin_;
+                    const char *p_;
+                    const char *end_;
+                    std::string text_;
+                };
+
+                // Readonly elements are skipped, elements with a setter are parsed into a temporary
+                struct element_reader
+                {
+                    typedef parser input_type;
+
+                    template<typename U>
+                    static void read(parser &in, U &v, const element &e)
+                    {
+                        in.parse(v, e);
+                    }
+
+                    static void skip(parser &in, const element &e) { in.skip_content(e); }
+                };
+
+                /*
+                 * Finds the end of the element whose start tag is at `p` by counting tags, without
+                 * checking them. need_more if it may continue past `end`; at the end of input an
+                 * incomplete element is returned whole and left for the parser to reject.
+                 */
+                inline scan_result element_end(const char *p, const char *end, bool eof, const char *&stop)
+                {
+                    std::size_t depth = 0;
+                    for (;;) {
+                        markup kind;
+                        const char *q = markup_end(p, end, kind);
+                        if (q == nullptr) {
+                            break;
+                        }
+                        depth += kind == markup::start_tag ? 1 : 0;
+                        depth -= kind == markup::end_tag ? 1 : 0;
+                        if (depth == 0) {
+                            stop = q;
+                            return scan_result::ok;
+                        }
+                        p = static_cast<const char *>(std::memchr(q, '<', std::size_t(end - q)));
+                        if (p == nullptr) {
+                            break;
+                        }
+                    }
+                    if (!eof) {
+                        return scan_result::need_more;
+                    }
+                    stop = end;
+                    return scan_result::ok;
+                }
+            }   // End of namespace detail
+
+            /**
+             * Parses an XML document whose root element is named like T straight into `t`, with no
+             * intermediate tree: child elements are matched to elements through a compile-time perfect
+             * hash of their qualified names (xml_namespace() prefix and xml_node()), unknown children
+             * are skipped, elements missing from the text are left untouched, containers are replaced.
+             * Prefixes are matched as written, xmlns declarations are not resolved. Malformed markup or
+             * values that don't fit their target throw std::invalid_argument.
+             */
+            template<typename T>
+            void parse(const char *data, std::size_t size, T &t)
+            {
+                detail::parser in(data, data + size);
+                in.parse_root(t);
+                in.finish();
+            }
+
+            template<typename T>
+            void parse(const std::string &text, T &t)
+            {
+                parse(text.data(), text.size(), t);
+            }
+
+            template<typename T>
+            T parse(const char *data, std::size_t size)
+            {
+                T t{};
+                parse(data, size, t);
+                return t;
+            }
+
+            template<typename T>
+            T parse(const std::string &text)
+            {
+                return parse<T>(text.data(), text.size());
+            }
+
+            /**
+             * Pulls the elements named like T out of an XML stream one record at a time, wherever they
+             * are in the document, e.g. the children of a feed's root element. Markup around the
+             * records is skipped without being checked. Input comes from memory or from a streambuf
+             * through a fixed buffer that only grows for a record larger than itself, so memory use
+             * doesn't depend on the size of the input. Each record is parsed like xml::parse,
+             * elements missing from it are left untouched by read(), errors throw
+             * std::invalid_argument.
+             */
+            template<typename T>
+            class reader : public reflection::detail::record_reader<reader<T>, T>
+            {
+                typedef reflection::detail::record_reader<reader<T>, T> base;
+                friend base;
+
+            public:
+                using base::default_buffer_size;
+
+                reader(const char *data, std::size_t size) : base(data, size) { }
+
+                explicit reader(std::streambuf &sb, std::size_t buffer_size = default_buffer_size)
+                        : base(sb, buffer_size)
+                {
+                }
+
+            private:
+                typedef detail::tags<detail::type_name<T>> type_tags;
+
+                // Skips to the start tag of the next record, what's skipped is committed to input_
+                detail::scan_result next(const char *&start)
+                {
+                    const char *p = input_.pos();
+                    const char *end = input_.end();
+                    for (;;) {
+                        const void *found = std::memchr(p, '<', std::size_t(end - p));
+                        if (found == nullptr) {
+                            input_.pos() = end;
+                            return input_.eof() ? detail::scan_result::end_of_input
+                                                : detail::scan_result::need_more;
+                        }
+                        p = static_cast<const char *>(found);
+                        input_.pos() = p;
+                        detail::markup kind;
+                        const char *q = detail::markup_end(p, end, kind);
+                        if (q == nullptr) {
+                            if (input_.eof()) {
+                                fail("unterminated markup");
+                            }
+                            return detail::scan_result::need_more;
+                        }
+                        if ((kind == detail::markup::start_tag || kind == detail::markup::empty_tag)
+                            && detail::name_end(p + 1, end) - (p + 1) == std::ptrdiff_t(type_tags::size)
+                            && std::memcmp(p + 1, type_tags::open.data + 1, type_tags::size) == 0) {
+                            start = p;
+                            return detail::scan_result::ok;
+                        }
+                        p = q;
+                        input_.pos() = p;
+                    }
+                }
+
+                // Bounds of the next record, for record_reader::read()
+                detail::scan_result scan_record(const char *&begin, const char *&end)
+                {
+                    detail::scan_result r = next(begin);
+                    end = begin;
+                    if (r == detail::scan_result::ok) {
+                        r = detail::element_end(begin, input_.end(), input_.eof(), end);
+                    }
+                    return r;
+                }
+
+                void parse_record(const char *begin, const char *end, T &t)
+                {
+                    try {
+                        detail::parser in(begin, end);
+                        in.parse_root(t);
+                    } catch (std::invalid_argument &e) {
+                        // Parser messages start with "xml: "
+                        throw std::invalid_argument("xml: record " + std::to_string(records_ + 1) + ": "
+                                                    + (e.what() + 5));
+                    }
+                }
+
+                [[noreturn]] void fail(const char *what) const
+                {
+                    throw std::invalid_argument(std::string("xml: ") + what + " after record "
+                                                + std::to_string(records_));
+                }
+
+                using base::input_;
+                using base::records_;
+            };
+
+            // Calls `f(T &&)` with each record read from `sb`, returns the number of records
+            template<typename T, typename F>
+            std::size_t for_each_record(std::streambuf &sb, F &&f)
+            {
+                return reader<T>(sb).for_each(std::forward<F>(f));
+            }
+        }
+    }
+    namespace xml = reflection::xml;
+}
+
+#endif // CXL_REFLECTION_XML_HPP
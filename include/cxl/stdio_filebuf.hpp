@@ -1,6 +1,7 @@
 #ifndef CXL_STDIO_FILEBUF_HPP
 #define CXL_STDIO_FILEBUF_HPP
 
+#include <cstring>
 #include <fstream>
 
 namespace cxl {
@@ -85,7 +86,7 @@ namespace cxl {
     template<class CharT, class Traits>
     stdio_filebuf<CharT, Traits>::stdio_filebuf()
             : extbuf_(0), extbufnext_(0), extbufend_(0), ebs_(0), intbuf_(0), ibs_(0), file_(0), cv_(nullptr), st_(),
-              st_last_(), om_(0), cm_(0), owns_eb_(false), owns_ib_(false), always_noconv_(false)
+              st_last_(), om_(), cm_(), owns_eb_(false), owns_ib_(false), always_noconv_(false)
     {
         if (std::has_facet<std::codecvt<char_type, char, state_type>>(this->getloc())) {
             cv_ = &std::use_facet<std::codecvt<char_type, char, state_type>>(this->getloc());
@@ -145,8 +146,8 @@ namespace cxl {
         rhs.file_ = 0;
         rhs.st_ = state_type();
         rhs.st_last_ = state_type();
-        rhs.om_ = 0;
-        rhs.cm_ = 0;
+        rhs.om_ = std::ios_base::openmode();
+        rhs.cm_ = std::ios_base::openmode();
         rhs.owns_eb_ = false;
         rhs.owns_ib_ = false;
         rhs.setg(0, 0, 0);
@@ -679,7 +680,7 @@ namespace cxl {
             if (update_st) st_ = state;
             extbufnext_ = extbufend_ = extbuf_;
             this->setg(0, 0, 0);
-            cm_ = 0;
+            cm_ = std::ios_base::openmode();
         }
         return 0;
     }
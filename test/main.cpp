@@ -1,5 +1,8 @@
 #include <assert.h>
 #include <iostream>
+#include <iterator>
+#include <cmath>
+#include <limits>
 #include <sstream>
 #include <fcntl.h>
 #include <vector>
@@ -9,6 +12,21 @@
 #include <cxl/str_lit.hpp>
 #include <cxl/reflection.hpp>
 #include <cxl/reflection/csv.hpp>
+#include <cxl/reflection/csv_parallel.hpp>
+#include <cxl/reflection/json.hpp>
+#include <cxl/reflection/xml.hpp>
+#include <cxl/reflection/binary.hpp>
+#include <cxl/reflection/msgpack.hpp>
+#include <cxl/reflection/field_handle.hpp>
+#include <cxl/reflection/parallel.hpp>
+#include <cxl/reflection/row_binder.hpp>
+#include <cxl/reflection/flatten.hpp>
+#include <cxl/reflection/map_fields.hpp>
+#include <cxl/reflection/hash.hpp>
+#include <cxl/reflection/patch.hpp>
+#include <cxl/reflection/tracked.hpp>
+#include <unordered_map>
+#include <unordered_set>
 
 #define STRINGIZE(x) STRINGIZE2(x)
 #define STRINGIZE2(x) #x
@@ -472,6 +490,1301 @@ void test_csv()
             "20,15.500000,284,100\n"
             "30,25.500000,384,100\n"
             "40,35.500000,484,100\n");
+
+    // The buffered writer has the same output, a small buffer is flushed many times
+    std::stringbuf sb;
+    char buffer[64];
+    {
+        cxl::reflection::csv::writer<SC> w(sb, buffer, sizeof(buffer));
+        w.write_header();
+        w.write(vsc.begin(), vsc.end());
+        assert(w.size() == ss.str().size());
+    }
+    assert(sb.str() == ss.str());
+
+    typedef std::tuple<int, long long, bool, double, double, double, std::string> row_t;
+    std::vector<row_t> rows;
+    rows.emplace_back(-42, -9223372036854775807LL - 1, true, -0.0, 1e300, -2.5, "a\"b\tc\x01");
+    rows.emplace_back(0, 1234567890123LL, false, 0.1, 3.0, 1e-7, std::string(100, 'x'));
+    std::stringstream expected;
+    std::ostream_iterator<char> eo(expected);
+    for (const row_t &r : rows) {
+        std::string s = std::get<6>(r);
+        expected << std::to_string(std::get<0>(r)) << ',' << std::to_string(std::get<1>(r)) << ','
+                 << std::to_string(std::get<2>(r)) << ',' << std::to_string(std::get<3>(r)) << ','
+                 << std::to_string(std::get<4>(r)) << ',' << std::to_string(std::get<5>(r)) << ",\"";
+        for (char c : s) {
+            cxl::reflection::csv::detail::escape(c, eo);
+        }
+        expected << "\"\n";
+    }
+    std::stringbuf rsb;
+    {
+        cxl::reflection::csv::writer<row_t> w(rsb, buffer, sizeof(buffer));
+        w.write(rows.begin(), rows.end());
+    }
+    assert(rsb.str() == expected.str());
+
+    // The vectorized scan finds every char that needs escaping, at any offset and in the tail
+    using cxl::reflection::csv::detail::find_escape;
+    for (char c : std::string("\"\\\t\r\n\x01\x1f")) {
+        for (std::size_t at = 0; at < 70; at++) {
+            std::string text(70, 'a');
+            text[at] = c;
+            assert(find_escape(text.data(), text.data() + text.size()) == text.data() + at);
+        }
+    }
+    std::string clean = "plain text with \x7f and \xc3\xa9 and spaces, commas; long enough for two blocks";
+    assert(find_escape(clean.data(), clean.data() + clean.size()) == clean.data() + clean.size());
+}
+
+void test_read_csv()
+{
+    std::vector<R> rows;
+    rows.push_back(R{1, "plain", 1.5, true, 10});
+    rows.push_back(R{-2, "q\"uo,te\\ tab\t nl\n cr\r \x01", -0.25, false, 18446744073709551615UL});
+    rows.push_back(R{3, "", 0, true, 0});
+    rows.push_back(R{4, std::string(200, 'y'), 123456.125, false, 4});
+    std::stringbuf sb;
+    {
+        cxl::reflection::csv::writer<R> w(sb);
+        w.write_header();
+        w.write(rows.begin(), rows.end());
+    }
+    std::string text = sb.str();
+    assert(text.substr(0, text.find('\n') + 1) == "\"id\",\"Name\",\"score\",\"active\",\"count\"\n");
+
+    auto same = [](const std::vector<R> &a, const std::vector<R> &b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); i++) {
+            if (!(a[i].id == b[i].id && a[i].name == b[i].name && a[i].score == b[i].score
+                  && a[i].active == b[i].active && a[i].count == b[i].count))
+                return false;
+        }
+        return true;
+    };
+    assert(same(cxl::reflection::csv::read_csv<R>(text), rows));
+
+    // A small buffer is refilled and grown for records larger than itself
+    std::stringbuf in(text);
+    cxl::reflection::csv::reader<R> reader(in, 64);
+    std::vector<R> back;
+    reader.read_all(std::back_inserter(back));
+    assert(same(back, rows) && reader.records() == 4);
+
+    // Columns in any order, unknown columns ignored, CRLF line ends, no final newline
+    std::vector<R> r2 = cxl::reflection::csv::read_csv<R>(
+            std::string("count,extra,\"id\"\r\n5,x,7\r\n\r\n6,\"y\",8"));
+    assert(r2.size() == 2 && r2[0].count == 5 && r2[0].id == 7 && r2[1].count == 6 && r2[1].id == 8);
+    assert(r2[0].name.empty() && r2[0].score == 0);
+
+    try {
+        cxl::reflection::csv::read_csv<R>(std::string("id,count\n1,x\n"));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        cxl::reflection::csv::read_csv<R>(std::string("id,count\n1\n"));
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+    try {
+        cxl::reflection::csv::read_csv<R>(std::string("id,Name\n1,\"abc\n"));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    // NaNs and infinities are read back in the spellings the writer uses
+    std::vector<R> special;
+    special.push_back(R{1, "x", std::numeric_limits<double>::quiet_NaN(), false, 0});
+    special.push_back(R{2, "y", -std::numeric_limits<double>::quiet_NaN(), false, 0});
+    special.push_back(R{3, "z", std::numeric_limits<double>::infinity(), false, 0});
+    special.push_back(R{4, "w", -std::numeric_limits<double>::infinity(), false, 0});
+    std::stringbuf ssb;
+    {
+        cxl::reflection::csv::writer<R> w(ssb);
+        w.write_header();
+        w.write(special.begin(), special.end());
+    }
+    std::vector<R> sback = cxl::reflection::csv::read_csv<R>(ssb.str());
+    assert(sback.size() == 4 && std::isnan(sback[0].score) && std::isnan(sback[1].score));
+    assert(sback[2].score == special[2].score && sback[3].score == special[3].score);
+
+    std::size_t visited = 0;
+    cxl::reflection::csv::reader<R> each(text.data(), text.size());
+    assert(each.for_each([&](R &&r) { visited += r.id == rows[visited].id; }) == 4 && visited == 4);
+    assert(each.records() == 4);
+
+    // Projections name fields by key or csv_field, the rest of each record is skipped unparsed
+    using cxl::reflection::csv::projection;
+    std::vector<R> ids = cxl::reflection::csv::read_csv<R>(text, projection{"id"});
+    assert(ids.size() == 4 && ids[1].id == -2 && ids[3].id == 4);
+    assert(ids[1].name.empty() && ids[1].score == 0 && ids[0].count == 0);
+    std::stringbuf pin(text);
+    std::vector<R> named = cxl::reflection::csv::read_csv<R>(pin, projection{"score", "name"});
+    assert(named.size() == 4 && named[1].name == rows[1].name && named[3].score == rows[3].score);
+    assert(named[1].id == 0 && !named[0].active);
+    std::string loose = "id,count\n1,x\n2,y";
+    std::vector<R> tail = cxl::reflection::csv::read_csv<R>(loose, projection{"id"});
+    assert(tail.size() == 2 && tail[1].id == 2);
+    std::string multiline = "id,score,Name\n1,0.5,\"x\ny\"\n2,1.5,\"z\"\n";
+    assert(cxl::reflection::csv::read_csv<R>(multiline).size() == 2);
+    tail = cxl::reflection::csv::read_csv<R>(multiline, projection{"id", "score"});
+    assert(tail.size() == 2 && tail[1].id == 2 && tail[1].score == 1.5 && tail[1].name.empty());
+    std::stringbuf min(multiline);
+    tail = cxl::reflection::csv::read_csv<R>(min, projection{"id"});
+    assert(tail.size() == 2 && tail[1].id == 2);
+    try {
+        cxl::reflection::csv::read_csv<R>(text, projection{"id", "missing"});
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+    try {
+        cxl::reflection::csv::read_csv<R>(std::string("id,count\n1,2\n"), projection{"Name"});
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+}
+
+void test_read_csv_parallel()
+{
+    using cxl::reflection::csv::detail::next_record;
+    std::string tricky = "1,\"a\\\nb\"\n2,\"c\\\\\"\n3";
+    const char *b = tricky.data(), *e = b + tricky.size();
+    assert(next_record(b, b, e) == b + 9);
+    assert(next_record(b, b + 3, e) == b + 9);
+    assert(next_record(b, b + 9, e) == b + 17);
+    assert(next_record(b, b + 17, e) == e);
+
+    std::vector<R> rows;
+    for (int i = 0; i < 120000; i++) {
+        rows.push_back(R{i, i % 7 == 0 ? "line\nbreak\\" : "name" + std::to_string(i), i * 0.5, i % 2 == 0, 7u});
+    }
+    std::stringbuf sb;
+    {
+        cxl::reflection::csv::writer<R> w(sb);
+        w.write_header();
+        w.write(rows.begin(), rows.end());
+    }
+    std::string text = sb.str();
+    assert(text.size() > 2 * cxl::reflection::csv::detail::min_chunk_size);
+    std::vector<R> back = cxl::reflection::csv::read_csv_parallel<R>(text.data(), text.size(), 4);
+    assert(back.size() == rows.size());
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        assert(back[i].id == rows[i].id && back[i].name == rows[i].name && back[i].score == rows[i].score);
+    }
+
+    char path[] = "/tmp/cxl_csv_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, text.data(), text.size()) == ssize_t(text.size()));
+    close(fd);
+    assert(cxl::reflection::csv::read_csv_file<R>(path).size() == rows.size());
+
+    // Raw LFs in quoted fields, from other writers, across chunk boundaries
+    using cxl::reflection::csv::detail::record_start;
+    std::string raw = "1,\"a\nb\",0.5,1,1\n2,\"c\",0.5,1,1\n";
+    assert(record_start(raw.data(), raw.data() + 1, raw.data() + raw.size(), 5) == raw.data() + 16);
+    std::string quoted = "id,Name,score,active,count\n";
+    for (int i = 0; i < 200000; i++) {
+        quoted += std::to_string(i) + ",\"aaaa\nb\",0.5,1,1\n";
+    }
+    assert(quoted.size() > 4 * cxl::reflection::csv::detail::min_chunk_size);
+    back = cxl::reflection::csv::read_csv_parallel<R>(quoted.data(), quoted.size(), 4);
+    assert(back.size() == 200000 && back[199999].id == 199999 && back[199999].name == "aaaa\nb");
+    // A boundary that scans as a record but is inside a quoted field
+    quoted = "id,Name,score,active,count\n";
+    for (int i = 0; i < 200000; i++) {
+        quoted += std::to_string(i) + ",\"x\n0,y,0.5,1,1\n\",0.5,1,1\n";
+    }
+    back = cxl::reflection::csv::read_csv_parallel<R>(quoted.data(), quoted.size(), 4);
+    assert(back.size() == 200000 && back[199999].name == "x\n0,y,0.5,1,1\n");
+    quoted += "9,\"unterminated";
+    try {
+        cxl::reflection::csv::read_csv_parallel<R>(quoted.data(), quoted.size(), 4);
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    std::stringbuf out;
+    std::size_t bytes = cxl::reflection::csv::write_csv_parallel(rows.begin(), rows.end(), out, true, 3, 1000);
+    assert(bytes == text.size() && out.str() == text);
+    std::stringbuf body;
+    cxl::reflection::csv::write_csv_parallel(rows.begin(), rows.begin() + 5, body, false, 8, 2);
+    assert(body.str() == text.substr(text.find('\n') + 1, body.str().size()));
+    assert(cxl::reflection::csv::write_csv_parallel(rows.end(), rows.end(), body, false) == 0);
+
+    fd = open(path, O_WRONLY | O_TRUNC);
+    assert(fd >= 0);
+    assert(cxl::reflection::csv::write_csv_parallel(rows.begin(), rows.end(), fd) == text.size());
+    close(fd);
+    assert(cxl::reflection::csv::read_csv_file<R>(path).size() == rows.size());
+    unlink(path);
+}
+
+void test_json_writer()
+{
+    using cxl::reflection::json::to_json;
+    J j{7, "Ann \"A\"\n\x01\\", {1, 2}, {{"a", 0.5}, {"b", -2}}, {3}, std::string("x"), {1, true}};
+    std::string expected = "{\"id\":7,\"full name\":\"Ann \\\"A\\\"\\n\\u0001\\\\\",\"tags\":[1,2],"
+                           "\"scores\":{\"a\":0.5,\"b\":-2},\"inner\":{\"m1\":3},\"v\":\"x\",\"flag\":[1,true]}";
+    assert(to_json(j) == expected);
+    j.v = 5;
+    j.tags.clear();
+    assert(to_json(j).find("\"tags\":[],") != std::string::npos && to_json(j).find("\"v\":5,") != std::string::npos);
+    assert(to_json(std::make_tuple(nullptr, false, -9223372036854775807LL - 1, 'A'))
+           == "[null,false,-9223372036854775808,65]");
+
+    static_assert(cxl::reflection::json::detail::escaped_size("a\"b\x01") == 10, POS);
+    constexpr auto fragment = cxl::reflection::json::detail::make_fragment<14>("a\"b\x01", true);
+    assert(std::string(fragment.data, 14) == ",\"a\\\"b\\u0001\":");
+
+    // Fewest digits that read back exactly, non-finite values as null
+    assert(to_json(0.1) == "0.1" && to_json(3.0) == "3" && to_json(-0.0) == "-0");
+    assert(to_json(1e-7) == "0.0000001" && to_json(123456.125) == "123456.125");
+    assert(to_json(1e300) == "1e+300" && to_json(1.0 / 3) == "0.3333333333333333");
+    assert(to_json(9007199254740993.0) == "9007199254740992" && to_json(0.1f) == "0.1");
+    assert(to_json(std::nan("")) == "null" && to_json(-HUGE_VAL) == "null");
+    std::uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < 100000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Random bit patterns, and decimals with 3 digits after the point
+        double d = double(state % 100000000) / 1000 - 5000;
+        if (i % 2 == 0) {
+            std::memcpy(&d, &state, sizeof(d));
+        }
+        if (std::isfinite(d)) {
+            assert(std::strtod(to_json(d).c_str(), nullptr) == d);
+        }
+        float f = float(d);
+        if (std::isfinite(f)) {
+            assert(std::strtof(to_json(f).c_str(), nullptr) == f);
+        }
+    }
+
+    // The streambuf writer has the same output, a small buffer is flushed many times
+    std::vector<J> js(50, j);
+    std::stringbuf sb;
+    char buffer[64];
+    {
+        cxl::reflection::json::writer w(sb, buffer, sizeof(buffer));
+        w.write(js);
+        w.put('\n');
+    }
+    assert(sb.str() == to_json(js) + "\n");
+    std::stringbuf sb2;
+    assert(cxl::reflection::json::write_json(sb2, j) == to_json(j).size() && sb2.str() == to_json(j));
+}
+
+void test_json_parser()
+{
+    J j{7, "Ann \"A\"\n\x01\\ \xc3\xa9", {1, 2}, {{"a", 0.5}, {"b", -2}}, {3}, std::string("x"), {1, true}};
+    J back = cxl::json::parse<J>(cxl::json::to_json(j));
+    assert(back.id == 7 && back.name == j.name && back.tags == j.tags && back.scores == j.scores);
+    assert(back.inner.m1 == 3 && back.v.get<std::string>() == "x" && back.flag == j.flag);
+
+    // Every key finds its element through the perfect hash, other keys find nothing
+    typedef cxl::json::detail::key_index<J> index;
+    for (std::size_t n = 0; n < cxl::tuple_size<J>::value; n++) {
+        const char *key = cxl::get_element_json_key<J>(n);
+        assert(index::find(key, std::strlen(key)) == n);
+    }
+    assert(index::find("name", 4) == 7 && index::find("", 0) == 7);
+
+    // Unknown keys of any type are skipped, escaped keys are matched, missing members are untouched
+    J k = cxl::json::parse<J>(std::string(" { \"x\" : [1, {\"a\": \"]}\\\"\"}, null], \"id\" : -3 ,"
+                                          "\"full\\u0020name\":\"\\u00e9\\ud83d\\ude00\\/\", \"y\": {}, "
+                                          "\"z\": -1.5e-3, \"v\": 12, \"w\": true } "));
+    assert(k.id == -3 && k.name == "\xc3\xa9\xf0\x9f\x98\x80/" && k.v.get<int>() == 12);
+    assert(k.tags.empty() && k.inner.m1 == 0 && k.flag.first == 0);
+
+    // Variant alternatives are tried in order
+    cxl::variant<int, double, std::string> v = cxl::json::parse<cxl::variant<int, double, std::string>>("1.5");
+    assert(v.get<double>() == 1.5);
+    v = cxl::json::parse<cxl::variant<int, double, std::string>>("-4");
+    assert(v.get<int>() == -4);
+
+    // Readonly members are skipped, members with a setter are set
+    SC sc(0, 0, 0);
+    cxl::json::parse(std::string("{\"m1\":1,\"m2\":9,\"m3\":4,\"m4\":7}"), sc);
+    assert(sc.m1 == 1 && sc.m2 == 0 && sc.get_m3() == 4);
+
+    std::vector<R> rows{R{1, "a", 0.25, true, 5}, R{2, "b", 1e300, false, 18446744073709551615UL}};
+    std::vector<R> rows2 = cxl::json::parse<std::vector<R>>(cxl::json::to_json(rows));
+    assert(rows2.size() == 2 && rows2[1].count == rows[1].count && rows2[1].score == 1e300 && rows2[0].active);
+    std::map<int, double> m{{1, 0.5}, {2, 1.5}};
+    assert((cxl::json::parse<std::map<int, double>>(cxl::json::to_json(m)) == m));
+    assert(std::isnan(cxl::json::parse<double>("null")));
+    assert(std::abs(cxl::json::parse<double>("0." + std::string(200, '3')) - 1.0 / 3) < 1e-15);
+
+    const char *bad[] = {"{\"id\": 01}", "{\"id\": 1.5}", "{\"id\": 1} x", "{\"full name\": \"abc}",
+                         "{\"id\" 1}", "{\"id\": 1,}", "{\"tags\": [1 2]}", "{\"id\": 99999999999}",
+                         "{\"x\": [1, 2}", "{\"full name\": \"\\q\"}", "{\"flag\": [1]}", "",
+                         // Unpaired surrogates
+                         "{\"full name\": \"\\ud83d\"}", "{\"full name\": \"\\ud83dx\"}",
+                         "{\"full name\": \"\\ud83d\\u0041\"}", "{\"full name\": \"\\ude00\\ud83d\"}"};
+    for (const char *text : bad) {
+        try {
+            cxl::json::parse<J>(std::string(text));
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+}
+
+void test_json_reader()
+{
+    std::vector<R> rows;
+    for (int i = 0; i < 2000; i++) {
+        rows.push_back(R{i, i % 5 == 0 ? std::string(300, '"') + "]}" : "n" + std::to_string(i), i * 0.5, i % 2 == 0, 9u});
+    }
+    auto same = [&rows](const std::vector<R> &back) {
+        if (back.size() != rows.size()) return false;
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            if (back[i].id != rows[i].id || back[i].name != rows[i].name || back[i].score != rows[i].score)
+                return false;
+        }
+        return true;
+    };
+
+    // JSON lines and one big array, through a buffer smaller than some records
+    std::stringbuf lines;
+    {
+        cxl::json::writer w(lines);
+        for (const R &r : rows) {
+            w.write(r);
+            w.put('\n');
+        }
+    }
+    std::stringbuf in(lines.str());
+    cxl::json::reader<R> reader(in, 256);
+    std::vector<R> back;
+    assert(reader.read_all(std::back_inserter(back)) == rows.size() && reader.records() == rows.size());
+    assert(same(back));
+
+    std::stringbuf array(" " + cxl::json::to_json(rows) + "\n");
+    back.clear();
+    assert(cxl::json::for_each_record<R>(array, [&back](R &&r) { back.push_back(std::move(r)); }) == rows.size());
+    assert(same(back));
+
+    std::string scalars = "[1, 2 ,3\n]";
+    std::vector<int> ints;
+    cxl::json::reader<int>(scalars.data(), scalars.size()).read_all(std::back_inserter(ints));
+    assert((ints == std::vector<int>{1, 2, 3}));
+    std::string spaced = "{\"m1\":1}{\"m1\":2}\n\n {\"m1\":3} ";
+    std::vector<S_inner> inners;
+    cxl::json::reader<S_inner>(spaced.data(), spaced.size()).read_all(std::back_inserter(inners));
+    assert(inners.size() == 3 && inners[2].m1 == 3);
+    for (const char *empty : {"", "  \n", "[]", " [ ] "}) {
+        assert(cxl::json::reader<int>(empty, std::strlen(empty)).read_all(std::back_inserter(ints)) == 0);
+    }
+
+    // Records that are arrays themselves are lines unless the format says otherwise
+    typedef std::pair<int, bool> pair_t;
+    std::string pair_lines = "[1, true]\n[2, false]\n";
+    std::vector<pair_t> pairs;
+    cxl::json::reader<pair_t>(pair_lines.data(), pair_lines.size()).read_all(std::back_inserter(pairs));
+    assert(pairs.size() == 2 && pairs[1] == pair_t(2, false));
+    std::string pair_array = "[[3, true], [4, false]]";
+    pairs.clear();
+    cxl::json::reader<pair_t>(pair_array.data(), pair_array.size(), cxl::json::stream_format::array)
+            .read_all(std::back_inserter(pairs));
+    assert(pairs.size() == 2 && pairs[0] == pair_t(3, true));
+    std::stringbuf int_lines(scalars);
+    std::vector<std::vector<int>> vectors;
+    cxl::json::reader<std::vector<int>>(int_lines).read_all(std::back_inserter(vectors));
+    assert(vectors.size() == 1 && vectors[0] == ints);
+    std::stringbuf array_lines(scalars);
+    try {
+        cxl::json::reader<int>(array_lines, 64, cxl::json::stream_format::lines).read_all(std::back_inserter(ints));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        cxl::json::reader<S_inner>(spaced.data(), spaced.size(), cxl::json::stream_format::array)
+                .read_all(std::back_inserter(inners));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    const char *bad[] = {"[1,]", "[1 2]", "[1, 2", "[1] 2", "1 x", "[1, {\"a\": 2}]", "{\"m1\": 1"};
+    for (const char *text : bad) {
+        try {
+            cxl::json::reader<S_inner>(text, std::strlen(text)).read_all(std::back_inserter(inners));
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+}
+
+void test_xml_writer()
+{
+    // Tags are built at compile time, with the namespace prefix
+    static_assert(cxl::xml::detail::tags<cxl::xml::detail::element_name<1, S>>::size == 9, "somens:m2");
+    static_assert(cxl::xml::detail::tags<cxl::xml::detail::type_name<J>>::open.data[1] == 'r', "record");
+
+    S s{1, 2.5, "a<b & \"c\"\n", {3}};
+    assert(cxl::xml::to_xml(s)
+           == "<S><m1>1</m1><somens:m2>2.5</somens:m2>"
+              "<MM3>a&lt;b &amp; \"c\"\n</MM3><m4><m1>3</m1></m4></S>");
+    assert(cxl::xml::to_xml(s, {{"xmlns:somens", "urn:x?a=1&b=\"2\""}})
+           .find("<S xmlns:somens=\"urn:x?a=1&amp;b=&quot;2&quot;\"><m1>") == 0);
+
+    J j{7, "n]]>", {1, 2}, {{"a b", 0.1}, {"<c>", -INFINITY}}, {4}, std::string("v"), {5, true}};
+    std::string text = cxl::xml::to_xml(j);
+    assert(text.find("<record><ident>7</ident><full_name>n]]&gt;</full_name><tags>") == 0);
+    assert(text.find("<tags><item>1</item><item>2</item></tags>") != std::string::npos);
+    assert(text.find("<scores><entry key=\"&lt;c&gt;\">-INF</entry><entry key=\"a b\">0.1</entry></scores>")
+           != std::string::npos);
+    assert(text.find("<inner><m1>4</m1></inner><v which=\"1\">v</v><flag><item>5</item><item>true</item></flag>"
+                     "</record>")
+           != std::string::npos);
+
+    s.m2 = NAN;
+    assert(cxl::xml::to_xml(s).find("<somens:m2>NaN</somens:m2>") != std::string::npos);
+    s.m3 = std::string(40, 'x') + "\x01";
+    try {
+        cxl::xml::to_xml(s);
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    // A feed of records through a small buffer
+    std::vector<S> rows;
+    for (int i = 0; i < 1000; i++) {
+        rows.push_back(S{i, i * 0.25, std::string(i % 50, '&'), {i}});
+    }
+    std::stringbuf out;
+    std::string expected = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<feed xmlns:somens=\"urn:s\">";
+    {
+        char buffer[64];
+        cxl::xml::writer w(out, buffer, sizeof(buffer));
+        w.declaration();
+        w.open("feed", {{"xmlns:somens", "urn:s"}});
+        for (const S &r : rows) {
+            w.write(r);
+            w.put('\n');
+            expected += cxl::xml::to_xml(r) + "\n";
+        }
+        w.close();
+        try {
+            w.close();
+            assert(false);
+        } catch (std::logic_error &) {
+        }
+        w.flush();
+        expected += "</feed>";
+        assert(w.size() == expected.size());
+    }
+    assert(out.str() == expected);
+}
+
+void test_xml_parser()
+{
+    J j{7, "Ann <&> \"A\"\n\xc3\xa9", {1, 2}, {{"a b", 0.5}, {"<c>", -INFINITY}}, {3}, std::string("x"),
+        {1, true}};
+    J back = cxl::xml::parse<J>(cxl::xml::to_xml(j));
+    assert(back.id == 7 && back.name == j.name && back.tags == j.tags && back.scores == j.scores);
+    assert(back.inner.m1 == 3 && back.v.get<std::string>() == "x" && back.flag == j.flag);
+
+    // The which attribute keeps apart alternatives the text alone can't, in members, items and entries
+    j.v = std::string("42");
+    back = cxl::xml::parse<J>(cxl::xml::to_xml(j));
+    assert(back.v.which() == 1 && back.v.get<std::string>() == "42");
+    N n{1, {{2}}, {{"a", {3}}}, S_inner{4}, {std::string("5"), 6}, {{"k", std::string("7")}}};
+    N nb = cxl::xml::parse<N>(cxl::xml::to_xml(n));
+    assert(cxl::equal(n, nb) && nb.mixed[0].which() == 1 && nb.labels["k"].which() == 1);
+    // Hand-written text without the attribute takes the first alternative that parses
+    J hand = cxl::xml::parse<J>(std::string("<record><v>42</v></record>"));
+    assert(hand.v.which() == 0 && hand.v.get<int>() == 42);
+    for (const char *which : {"<record><v which=\"2\">1</v></record>",
+                              "<record><v which=\"x\">1</v></record>",
+                              "<record><v which=\"0\">a</v></record>"}) {
+        try {
+            cxl::xml::parse<J>(which, std::strlen(which));
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+
+    // Every qualified name finds its element through the perfect hash
+    typedef cxl::xml::detail::name_index<S> index;
+    assert(index::find("m1", 2) == 0 && index::find("somens:m2", 9) == 1 && index::find("MM3", 3) == 2);
+    assert(index::find("m2", 2) == 4 && index::find("m4", 2) == 3);
+
+    // Prolog, comments, CDATA, references, attributes, whitespace around numbers and unknown children
+    S s = cxl::xml::parse<S>(std::string("<?xml version=\"1.0\"?>\n<!DOCTYPE S [<!ENTITY x \"y\">]>\n"
+                                         "<!-- <S> --><S a=\"1>2\" b='\"'>\n"
+                                         "  <unknown><m1>9</m1><x/><![CDATA[</unknown>]]></unknown>\n"
+                                         "  <m1> -12 </m1><somens:m2>\t2.5e1\n</somens:m2>\n"
+                                         "  <MM3>&lt;a&#x41;&#233;<!-- c --><![CDATA[<&>]]>&amp;</MM3>\n"
+                                         "  <m4 k=\"v\"><m1>3</m1></m4>\n"
+                                         "</S> <!-- end -->\n"));
+    assert(s.m1 == -12 && s.m2 == 25 && s.m3 == "<aA\xc3\xa9<&>&" && s.m4.m1 == 3);
+    S empty{1, 2, "x", {4}};
+    cxl::xml::parse("<S><MM3/><m4/></S>", empty);
+    assert(empty.m1 == 1 && empty.m3.empty() && empty.m4.m1 == 4);
+    S special = cxl::xml::parse<S>(std::string("<S><somens:m2>-INF</somens:m2></S>"));
+    assert(std::isinf(special.m2) && special.m2 < 0);
+    special = cxl::xml::parse<S>(std::string("<S><somens:m2> NaN </somens:m2></S>"));
+    assert(std::isnan(special.m2));
+
+    // Line ends are normalized, character references are not
+    S lines = cxl::xml::parse<S>(std::string("<S><MM3>a\r\nb\rc<![CDATA[\r\n]]>&#13;</MM3></S>"));
+    assert(lines.m3 == "a\nb\nc\n\r");
+    lines = cxl::xml::parse<S>(std::string("<S><MM3>a\r\n</MM3></S>"));
+    assert(lines.m3 == "a\n");
+
+    const char *bad[] = {"<S><m1>1</m2></S>", "<S><m1>x</m1></S>", "<S><m1>1<b/></m1></S>", "<T></T>",
+                         "<S><MM3>&nbsp;</MM3></S>", "<S><m1>1</m1>", "<S></S><S></S>", "<S a=1></S>",
+                         "<S><!-- </S>", "<S><somens:m2>0x1p3</somens:m2></S>",
+                         "<S><somens:m2>infinity</somens:m2></S>", "<S><somens:m2>nan(1)</somens:m2></S>",
+                         "<S><somens:m2>inf</somens:m2></S>"};
+    for (const char *text : bad) {
+        try {
+            cxl::xml::parse<S>(text, std::strlen(text));
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+
+    // Records are pulled out of a feed through a buffer smaller than some of them
+    std::vector<S> rows;
+    for (int i = 0; i < 2000; i++) {
+        rows.push_back(S{i, i * 0.25, i % 7 == 0 ? std::string(200, '<') : "n" + std::to_string(i), {-i}});
+    }
+    std::stringbuf feed;
+    {
+        cxl::xml::writer w(feed);
+        w.declaration();
+        w.open("feed", {{"xmlns:somens", "urn:s"}});
+        for (const S &r : rows) {
+            w.write(r);
+            w.put('\n');
+        }
+        w.close();
+    }
+    std::string text = feed.str();
+    text.insert(text.find("<S>", 100), "<!-- <S><m1>-1</m1></S> --><other><S2/></other>");
+    std::stringbuf in(text);
+    cxl::xml::reader<S> reader(in, 64);
+    std::vector<S> read;
+    assert(reader.read_all(std::back_inserter(read)) == rows.size() && reader.records() == rows.size());
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        assert(read[i].m1 == rows[i].m1 && read[i].m2 == rows[i].m2 && read[i].m3 == rows[i].m3);
+        assert(read[i].m4.m1 == rows[i].m4.m1);
+    }
+    std::size_t count = 0;
+    auto counter = [&count](S &&) { count++; };
+    assert(cxl::xml::reader<S>(text.data(), text.size()).for_each(counter) == rows.size());
+    assert(count == rows.size());
+
+    std::string broken = "<feed><S><m1>1</m1></S><S><m1>x</m1></S></feed>";
+    try {
+        cxl::xml::reader<S>(broken.data(), broken.size()).read_all(std::back_inserter(read));
+        assert(false);
+    } catch (std::invalid_argument &e) {
+        assert(std::string(e.what()).find("xml: record 2: ") == 0);
+    }
+}
+
+void test_binary()
+{
+    // Fingerprints are compile time constants that follow keys and types
+    static_assert(cxl::binary::fingerprint<S>() == cxl::binary::fingerprint<const S>(), "cv is ignored");
+    static_assert(cxl::binary::fingerprint<S>() != cxl::binary::fingerprint<S_v2>(), "keys and types");
+    static_assert(cxl::binary::fingerprint<std::pair<int, double>>()
+                  == cxl::binary::fingerprint<std::tuple<int, double>>(), "same encoding");
+    static_assert(cxl::binary::fingerprint<std::vector<int>>()
+                  != cxl::binary::fingerprint<std::vector<long>>(), "widths");
+
+    // a, b and c are one run, flag breaks it, d is alone
+    typedef cxl::binary::detail::run_end<0, B> run;
+    static_assert(run::value == 16, "a, b, c");
+    static_assert(cxl::binary::detail::member_kind<1, B>::value == 2, "b is in a's run");
+    static_assert(cxl::binary::detail::member_kind<4, B>::value == 1, "d starts a run");
+
+    B b{1, -2, 0.5, true, 7, {1.5, -2.5, 1e300}, std::string("text")};
+    std::string data = cxl::binary::encode(b);
+    assert(data.size() == 8 + 16 + 1 + 2 + (1 + 3 * 8) + (1 + 1 + 4));
+    B back = cxl::binary::decode<B>(data);
+    assert(back.a == 1 && back.b == -2 && back.c == 0.5 && back.flag && back.d == 7);
+    assert(back.values == b.values && back.v.get<std::string>() == "text");
+    b.v = 5;
+    cxl::binary::decode(cxl::binary::encode(b), back);
+    assert(back.v.get<int>() == 5);
+
+    J j{7, "Ann", {1, 2}, {{"a", 0.5}, {"b", -2}}, {3}, 12, {1, true}};
+    J jb = cxl::binary::decode<J>(cxl::binary::encode(j));
+    assert(jb.id == 7 && jb.name == j.name && jb.tags == j.tags && jb.scores == j.scores);
+    assert(jb.inner.m1 == 3 && jb.v.get<int>() == 12 && jb.flag == j.flag);
+
+    // Readonly elements are written and skipped, attributes go through their accessors
+    SC sc(1, 2.5, 3);
+    std::string scd = cxl::binary::encode(sc);
+    SC sc2(0, 0, 0);
+    cxl::binary::decode(scd, sc2);
+    assert(sc2.m1 == 1 && sc2.m2 == 0 && sc2.get_m3() == 3);
+
+    // Truncated input, trailing bytes, another schema and invalid values throw
+    std::string s_data = cxl::binary::encode(S{1, 2, "three", {4}});
+    std::vector<std::string> bad = {s_data.substr(0, s_data.size() - 1), s_data + '\0', s_data.substr(0, 4)};
+    std::string huge = cxl::binary::encode(std::vector<double>());
+    huge.back() = '\x7f';
+    std::string flag = cxl::binary::encode(b);
+    flag[8 + 16] = 2;
+    for (const std::string &d : bad) {
+        try {
+            cxl::binary::decode<S>(d);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+    for (const std::string &d : {huge, s_data}) {
+        try {
+            cxl::binary::decode<std::vector<double>>(d);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+    try {
+        cxl::binary::decode<B>(flag);
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+}
+
+void test_binary_tagged()
+{
+    // Header, field count, then tag, size and value of every field, S_inner nested the same way
+    S s{1, 2.5, "three", {4}};
+    std::string data = cxl::binary::encode_tagged(s);
+    assert(data.size() == 12 + 1 + (8 + 4) + (8 + 8) + (8 + 1 + 5) + (8 + 1 + 8 + 4));
+    S back = cxl::binary::decode_tagged<S>(data);
+    assert(back.m1 == 1 && back.m2 == 2.5 && back.m3 == "three" && back.m4.m1 == 4);
+
+    J j{7, "Ann", {1, 2}, {{"a", 0.5}}, {3}, std::string("x"), {1, true}};
+    J jb = cxl::binary::decode_tagged<J>(cxl::binary::encode_tagged(j));
+    assert(jb.id == 7 && jb.name == j.name && jb.tags == j.tags && jb.scores == j.scores);
+    assert(jb.inner.m1 == 3 && jb.v.get<std::string>() == "x" && jb.flag == j.flag);
+
+    SC sc(1, 2.5, 3);
+    SC sc2(0, 0, 0);
+    cxl::binary::decode_tagged(cxl::binary::encode_tagged(sc), sc2);
+    assert(sc2.m1 == 1 && sc2.m2 == 0 && sc2.get_m3() == 3);
+
+    // Fields are matched by key and type: MM3 and m4 are kept, m1 and m2 changed type and are
+    // dropped, extra is missing and reset
+    S_v2 v2{"old", 5, 9, {8}, "old"};
+    cxl::binary::decode_tagged(data, v2);
+    assert(v2.m3 == "three" && v2.m1 == 0 && v2.extra == 0 && v2.m4.m1 == 4 && v2.m2.empty());
+    v2 = S_v2{"v2", 5, 9, {8}, "two"};
+    back = cxl::binary::decode_tagged<S>(cxl::binary::encode_tagged(v2));
+    assert(back.m1 == 0 && back.m2 == 0 && back.m3 == "v2" && back.m4.m1 == 8);
+    std::vector<S_v2> all = cxl::binary::decode_tagged<std::vector<S_v2>>(
+            cxl::binary::encode_tagged(std::vector<S>{s, s}));
+    assert(all.size() == 2 && all[1].m3 == "three" && all[1].m4.m1 == 4);
+
+    // Objects are told apart by shape only: another reflected type reads like another version
+    B b{1, 2, 3.5, true, 4, {1.0}, std::string("s")};
+    J jj = cxl::binary::decode_tagged<J>(cxl::binary::encode_tagged(b));
+    assert(jj.id == 0 && jj.name.empty() && jj.tags.empty() && jj.flag == std::make_pair(0, false));
+    assert(jj.v.get<std::string>() == "s");
+
+    // Another top-level shape, the compact encoding, truncated input and bad field sizes throw
+    std::string size = data;
+    size[12 + 1 + 4] = 3;
+    for (const std::string &d : {data.substr(0, data.size() - 1), cxl::binary::encode(s), size}) {
+        try {
+            cxl::binary::decode_tagged<S>(d);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+    try {
+        cxl::binary::decode_tagged<std::vector<S>>(data);
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+}
+
+std::string to_hex(const std::string &s)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string ret;
+    for (unsigned char c : s) {
+        ret += digits[c >> 4];
+        ret += digits[c & 15];
+    }
+    return ret;
+}
+
+std::string from_hex(const std::string &s)
+{
+    std::string ret;
+    for (std::size_t i = 0; i + 1 < s.size(); i += 2) {
+        ret += char(std::stoi(s.substr(i, 2), nullptr, 16));
+    }
+    return ret;
+}
+
+void test_msgpack()
+{
+    // Integers in the smallest format, non-negative ones unsigned, as other implementations write them
+    std::vector<std::pair<long long, std::string>> ints = {
+            {0, "00"}, {127, "7f"}, {128, "cc80"}, {256, "cd0100"}, {65536, "ce00010000"},
+            {4294967296LL, "cf0000000100000000"}, {-1, "ff"}, {-32, "e0"}, {-33, "d0df"},
+            {-129, "d1ff7f"}, {-32769, "d2ffff7fff"}, {-2147483649LL, "d3ffffffff7fffffff"}};
+    for (const auto &i : ints) {
+        assert(to_hex(cxl::msgpack::encode(i.first)) == i.second);
+        assert(cxl::msgpack::decode<long long>(cxl::msgpack::encode(i.first)) == i.first);
+    }
+    assert(to_hex(cxl::msgpack::encode(std::string(31, 'x'))).substr(0, 2) == "bf");
+    assert(to_hex(cxl::msgpack::encode(std::string(32, 'x'))).substr(0, 4) == "d920");
+    assert(to_hex(cxl::msgpack::encode(std::vector<int>(16))).substr(0, 6) == "dc0010");
+    assert(to_hex(cxl::msgpack::encode(1.5)) == "cb3ff8000000000000");
+
+    // Objects as maps keyed by key() or as arrays, both read back
+    J j{7, "Ann", {1, 2}, {{"a", 0.5}}, {3}, std::string("x"), {1, true}};
+    std::string map = cxl::msgpack::encode(j);
+    assert(to_hex(map).find("87a2696407a46e616d65a3416e6e") == 0);
+    std::string array = cxl::msgpack::encode(j, cxl::msgpack::layout::array);
+    assert(to_hex(array).find("9707a3416e6e") == 0);
+    for (const std::string &d : {map, array}) {
+        J jb = cxl::msgpack::decode<J>(d);
+        assert(jb.id == 7 && jb.name == j.name && jb.tags == j.tags && jb.scores == j.scores);
+        assert(jb.inner.m1 == 3 && jb.v.get<std::string>() == "x" && jb.flag == j.flag);
+    }
+
+    // Written by Python's msgpack: unknown keys are skipped, whatever they hold, bin reads as a
+    // string, integers as floats, and elements missing from the map are left untouched
+    J from{0, "", {9}, {}, {4}, 0, {0, true}};
+    cxl::msgpack::decode(from_hex("87a4666c61679202c2a5657874726184a161920181a162c0a163c40362696ea164cb3ff8"
+                                  "000000000000a165d2fffeee90a26964cd012ca673636f72657381a17a02a17605a966756c"
+                                  "6c206e616d65a178a46e616d65c402426f"), from);
+    assert(from.id == 300 && from.name == "Bo" && from.tags == std::vector<int>{9});
+    assert(from.scores.at("z") == 2 && from.inner.m1 == 4 && from.v.get<int>() == 5);
+    assert(from.flag.first == 2 && !from.flag.second);
+
+    // A variant takes the first alternative that accepts the value
+    typedef cxl::variant<std::int8_t, std::string, double> V;
+    assert(cxl::msgpack::decode<V>(cxl::msgpack::encode(300)).get<double>() == 300);
+    assert(cxl::msgpack::decode<V>(cxl::msgpack::encode(-3)).get<std::int8_t>() == -3);
+
+    // Readonly elements are written and skipped
+    SC sc(1, 2.5, 3);
+    SC sc2(0, 0, 0);
+    cxl::msgpack::decode(cxl::msgpack::encode(sc), sc2);
+    assert(sc2.m1 == 1 && sc2.m2 == 0 && sc2.get_m3() == 3);
+
+    // Truncated input, trailing bytes, invalid types, mismatched types and integers out of range throw
+    std::vector<std::string> bad = {map.substr(0, map.size() - 1), map + '\0', from_hex("81a178c1"),
+                                    cxl::msgpack::encode(std::vector<int>{1, 2, 3})};
+    for (const std::string &d : bad) {
+        try {
+            cxl::msgpack::decode<J>(d);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+    try {
+        cxl::msgpack::decode<std::uint8_t>(cxl::msgpack::encode(-1));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        cxl::msgpack::decode<std::pair<int, bool>>(cxl::msgpack::encode(std::vector<int>{1}));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+}
+
+void test_element_descriptors()
+{
+    constexpr const cxl::element_descriptor *d = cxl::get_element_descriptors<S>();
+    static_assert(d[2].key[0] == 'M', POS);
+    static_assert(d[1].offset == offsetof(S, m2), POS);
+    static_assert(d[3].size == sizeof(S_inner) && d[3].alignment == alignof(S_inner), POS);
+    static_assert(!d[0].readonly && !d[0].use_value, POS);
+    assert(std::string(d[1].sql_field) == "field2");
+    assert(std::string(d[1].xml_namespace) == "somens");
+    assert(std::string(d[2].csv_field) == "MM3");
+
+    constexpr const cxl::element_descriptor *dsc = cxl::get_element_descriptors<SC>();
+    static_assert(dsc[1].readonly && dsc[3].readonly && dsc[3].use_value, POS);
+    static_assert(dsc[2].offset == std::size_t(-1), POS);
+
+    std::string keys;
+    for (std::size_t i = 0; i < cxl::tuple_size<S>::value; i++) {
+        keys += d[i].key;
+    }
+    assert(keys == "m1m2MM3m4");
+    try {
+        cxl::get_element_descriptor<S>(4);
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+}
+
+void test_index_of()
+{
+    static_assert(cxl::index_of<S>("m1") == 0, POS);
+    static_assert(cxl::index_of<S>("MM3") == 2, POS);
+    static_assert(!cxl::has_element<S>("m3"), POS);
+    static_assert(cxl::index_of<std::pair<int, double>>("second") == 1, POS);
+    static_assert(std::is_same<CXL_FIELD(S, "MM3")::type, std::string>::value, POS);
+
+    S s{420, 4.2, "hello", {4200}};
+    CXL_FIELD(S, "m1")::set(s, 210);
+    assert(s.m1 == 210);
+    std::get<cxl::index_of<S>("MM3")>(s) = "world";
+    assert(CXL_FIELD(S, "MM3")::get(s) == "world");
+    try {
+        // Evaluated at run time
+        cxl::index_of<S>(std::string("unknown").c_str());
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+}
+
+void test_field_handle()
+{
+    static_assert(cxl::reflection::element_has_offset<0, S>, POS);
+    static_assert(!cxl::reflection::element_has_offset<2, SC>, POS);
+
+    std::vector<S> vs{{1, 1.5, "a", {10}}, {2, 2.5, "b", {20}}};
+    auto h1 = cxl::make_field_handle<S>("m1");
+    auto h3 = cxl::make_field_handle<S>("MM3");
+    assert(h1.direct() && h3.direct());
+    assert(h3.index() == 2);
+    assert(h1.holds<int>() && !h1.holds<double>());
+    int sum = 0;
+    for (const S &s : vs) {
+        sum += h1.get<int>(s);
+    }
+    assert(sum == 3);
+    h3.set(vs[1], std::string("world"));
+    assert(vs[1].m3 == "world");
+    assert(h3.get<std::string>(vs[1]) == "world");
+    try {
+        // Type mismatch
+        h1.get<double>(vs[0]);
+        assert(false);
+    } catch (cxl::bad_get &) {
+    }
+    try {
+        cxl::make_field_handle<S>("unknown key");
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+
+    // Getter/setter attributes and readonly members
+    SC sc{10, 5.5, 84};
+    cxl::field_handle<SC> hm3(2), hm4(3), hm2(1);
+    assert(!hm3.direct() && !hm3.readonly());
+    assert(hm4.readonly() && hm2.readonly());
+    hm3.set(sc, 168);
+    assert(hm3.get<int>(sc) == 168);
+    assert(hm4.get<int>(sc) == 100);
+    assert(hm2.get<double>(sc) == 5.5);
+    try {
+        hm4.set(sc, 1);
+        assert(false);
+    } catch (std::bad_cast &) {
+    }
+}
+
+struct indexed_visitor
+{
+    template<typename T, std::size_t I, typename Meta>
+    void operator()(const T &t, std::integral_constant<std::size_t, I>, Meta) const
+    {
+        static_assert(Meta::index == I, POS);
+        if (I > 0) os << ",";
+        os << Meta::key() << "=" << t;
+    }
+
+    std::ostream &os;
+};
+
+struct field_counter
+{
+    template<typename T, std::size_t I, typename Meta>
+    void operator()(T &, std::integral_constant<std::size_t, I>, Meta) const
+    {
+        counts[I]++;
+    }
+
+    std::vector<std::size_t> &counts;
+};
+
+void test_for_each_element_indexed()
+{
+    S s{420, 4.2, "hello", {4200}};
+    std::stringstream ss;
+    cxl::for_each_element_indexed(s, indexed_visitor{ss});
+    assert(ss.str() == "m1=420,m2=4.2,MM3=hello,m4=S_inner{4200}");
+
+    std::vector<S> vs(100, s);
+    std::vector<std::size_t> counts(cxl::tuple_size<S>::value);
+    cxl::parallel_for_each_element(vs, field_counter{counts}, 3);
+    for (std::size_t n : counts) {
+        assert(n == vs.size());
+    }
+    cxl::for_each_element(vs, field_counter{counts});
+    for (std::size_t n : counts) {
+        assert(n == 2 * vs.size());
+    }
+}
+
+void test_row_binder()
+{
+    std::vector<std::string> header{"MM3", "m1", "bogus"};
+    cxl::row_binder<S> binder(header);
+    assert(binder.columns() == 3);
+    assert(binder.element_index(0) == 2 && binder.element_index(1) == 0 && !binder.mapped(2));
+    assert(binder.unmapped_columns() == std::vector<std::size_t>{2});
+    assert((binder.missing_elements() == std::vector<std::size_t>{1, 3}));
+    assert(!binder.complete());
+
+    S s{420, 4.2, "hello", {4200}};
+    std::vector<std::string> text{"world", "-42", "ignored"};
+    binder.parse_row(s, text);
+    assert(s.m3 == "world" && s.m1 == -42);
+
+    std::vector<cxl::to_variant_t<S>> row{std::string("again"), 7, 1.5};
+    binder.assign_row(s, row);
+    assert(s.m3 == "again" && s.m1 == 7 && s.m2 == 4.2);
+
+    try {
+        binder.parse(s, 1, "4x2");
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        binder.parse(s, 1, "2147483648");
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    binder.parse(s, 1, "-2147483648");
+    assert(s.m1 == -2147483647 - 1);
+    try {
+        binder.parse(s, 3, "1");
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    // Floats are decimal, or the NaN and infinity spellings of "%f", as strict as integers
+    cxl::row_binder<S> floats{"m2"};
+    floats.parse(s, 0, "-1.25e+2");
+    assert(s.m2 == -125);
+    floats.parse(s, 0, "1." + std::string(300, '0') + "1e-300");
+    assert(s.m2 == 1e-300);
+    floats.parse(s, 0, "-inf");
+    assert(std::isinf(s.m2) && s.m2 < 0);
+    floats.parse(s, 0, "nan");
+    assert(std::isnan(s.m2));
+    for (const char *text : {" 1.5", "0x1p3", "INF", "-INF", "NaN", "+inf", "infinity", "1e", ".", "1.5 "}) {
+        try {
+            floats.parse(s, 0, text);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+    }
+    try {
+        binder.parse_row(s, std::vector<std::string>{"a", "1"});
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+
+    // Readonly elements are never bound, attributes go through their setters
+    cxl::row_binder<SC> scb{"m1", "m2", "m3", "m4"};
+    assert((scb.unmapped_columns() == std::vector<std::size_t>{1, 3}));
+    assert(scb.missing_elements().empty());
+    SC sc{10, 5.5, 84};
+    scb.parse_row(sc, std::vector<std::string>{"7", "1.5", "99", "100"});
+    assert(sc.m1 == 7 && sc.m2 == 5.5 && sc.get_m3() == 99);
+}
+
+void test_flatten()
+{
+    static_assert(cxl::flat_size<S>::value == 4, POS);
+    static_assert(cxl::flat_index_of<S>("m4.m1") == 3, POS);
+    static_assert(cxl::flat_element<3, S>::depth == 2, POS);
+    static_assert(cxl::get_flat_descriptors<S>()[3].offset == offsetof(S, m4) + offsetof(S_inner, m1), POS);
+    static_assert(std::is_same<cxl::flat_element<3, S>::type, int>::value, POS);
+
+    S s{420, 4.2, "hello", {4200}};
+    std::string paths;
+    for (std::size_t i = 0; i < cxl::flat_size<S>::value; i++) {
+        if (!paths.empty()) paths += ",";
+        paths += cxl::get_flat_descriptor<S>(i).path;
+    }
+    assert(paths == "m1,m2,MM3,m4.m1");
+    assert(cxl::get_flat_variant(3, s).get<int>() == 4200);
+    cxl::set_flat(3, s, 5);
+    assert(s.m4.m1 == 5);
+    assert((cxl::flat_element<3, S>::get(s) == 5));
+    assert(std::string(cxl::get_flat_descriptor<S>(2).leaf->key) == "MM3");
+
+    // Nested through std::pair, tuples/pairs/arrays as members stay leaves
+    typedef std::pair<int, S> ps_t;
+    static_assert(cxl::flat_size<ps_t>::value == 5, POS);
+    static_assert(cxl::flat_index_of<ps_t>("second.m4.m1") == 4, POS);
+    ps_t ps(1, s);
+    cxl::set_flat(4, ps, 6);
+    assert(ps.second.m4.m1 == 6);
+    try {
+        cxl::set_flat(2, ps, 1);
+        assert(false);
+    } catch (cxl::bad_get &) {
+    }
+}
+
+// Converts S::m2 to and from S_v2::m2, other values go through default_conversion
+struct v2_conversion : cxl::default_conversion
+{
+    using cxl::default_conversion::operator();
+
+    std::string operator()(double v, cxl::reflection::reflected_element<4, S_v2>) const
+    {
+        std::ostringstream ss;
+        ss << v;
+        return ss.str();
+    }
+
+    double operator()(const std::string &v, cxl::reflection::reflected_element<1, S>) const
+    {
+        return std::stod(v);
+    }
+};
+
+void test_map_fields()
+{
+    static_assert(cxl::mapped_count<S_v2, S>::value == 4, POS);
+    static_assert(cxl::mapped_count<S, S_v2>::value == 4, POS);
+
+    S s{420, 4.2, "hello", {4200}};
+    S_v2 v2 = cxl::map_fields<S_v2>(s, v2_conversion());
+    assert(v2.m1 == 420 && v2.m2 == "4.2" && v2.m3 == "hello" && v2.m4.m1 == 4200 && v2.extra == 0);
+
+    // Unmatched members are left alone, rvalue sources are moved from, leaving them in an
+    // unspecified state
+    v2.m3 = std::string(100, 'x');
+    v2.m1 = 7;
+    S t{1, 2.5, "", {2}};
+    cxl::assign_fields(t, std::move(v2), v2_conversion());
+    assert(t.m1 == 7 && t.m2 == 4.2 && t.m3 == std::string(100, 'x') && t.m4.m1 == 4200);
+
+    // Readonly members of the destination are skipped
+    static_assert(cxl::mapped_count<SC, S>::value == 1, POS);
+    SC sc(1, 2.0, 3);
+    cxl::assign_fields(sc, s);
+    assert(sc.m1 == 420 && sc.m2 == 2.0);
+}
+
+CXL_REFLECTED_STD_HASH(S)
+
+void test_hash()
+{
+    static_assert(std::is_same<cxl::reflection::detail::member_kind<0, S>,
+                               cxl::reflection::detail::run_start>::value, POS);
+    static_assert(std::is_same<cxl::reflection::detail::member_kind<1, S>,
+                               cxl::reflection::detail::by_value>::value, POS);
+
+    S a{420, 4.2, "hello", {4200}};
+    S b = a;
+    assert(cxl::equal(a, b) && cxl::hash_value(a) == cxl::hash_value(b));
+    b.m4.m1 = 1;
+    assert(!cxl::equal(a, b) && cxl::hash_value(a) != cxl::hash_value(b));
+    b = a;
+    b.m3 = "world";
+    assert(!cxl::equal(a, b) && cxl::hash_value(a) != cxl::hash_value(b));
+    b = a;
+    a.m2 = 0.0;
+    b.m2 = -0.0;
+    assert(cxl::equal(a, b) && cxl::hash_value(a) == cxl::hash_value(b));
+
+    // Adjacent int members form a single run
+    typedef std::array<int, 4> arr_t;
+    static_assert(cxl::reflection::detail::run_end<0, arr_t>::value == sizeof(arr_t), POS);
+    static_assert(std::is_same<cxl::reflection::detail::member_kind<3, arr_t>,
+                               cxl::reflection::detail::in_run>::value, POS);
+    arr_t x{{1, 2, 3, 4}}, y{{1, 2, 3, 5}};
+    assert(!cxl::equal(x, y) && cxl::hash_value(x) != cxl::hash_value(y));
+    y[3] = 4;
+    assert(cxl::equal(x, y) && cxl::hash_value(x) == cxl::hash_value(y));
+
+    // Getter/setter members are compared by value
+    SC c1(1, 2.0, 3), c2(1, 2.0, 3);
+    assert(cxl::equal(c1, c2) && cxl::hash_value(c1) == cxl::hash_value(c2));
+    c2.set_m3(4);
+    assert(!cxl::equal(c1, c2));
+
+    // Pointer members outside a run are hashed by address
+    static_assert(std::is_same<cxl::reflection::detail::member_kind<0, HP>,
+                               cxl::reflection::detail::by_value>::value, POS);
+    int i1 = 0, i2 = 0;
+    HP h1, h2;
+    h1.p = h2.p = &i1;
+    h1.n = h2.n = 1;
+    assert(cxl::equal(h1, h2) && cxl::hash_value(h1) == cxl::hash_value(h2));
+    h2.p = &i2;
+    assert(!cxl::equal(h1, h2) && cxl::hash_value(h1) != cxl::hash_value(h2));
+
+    // Containers and variants are compared and hashed element by element
+    J j1{1, "j", {1, 2}, {{"a", 0.5}}, {3}, std::string("x"), {4, true}};
+    J j2 = j1;
+    assert(cxl::equal(j1, j2) && cxl::hash_value(j1) == cxl::hash_value(j2));
+    j2.tags.push_back(3);
+    assert(!cxl::equal(j1, j2) && cxl::hash_value(j1) != cxl::hash_value(j2));
+    N n1{1, {{1}, {2}}, {{"a", {3}}}, S_inner{4}};
+    N n2 = n1;
+    assert(cxl::equal(n1, n2) && cxl::hash_value(n1) == cxl::hash_value(n2));
+    n2.items[1].m1 = 5;
+    assert(!cxl::equal(n1, n2) && cxl::hash_value(n1) != cxl::hash_value(n2));
+    n2 = n1;
+    n2.named["a"].m1 = 5;
+    assert(!cxl::equal(n1, n2) && cxl::hash_value(n1) != cxl::hash_value(n2));
+    n2 = n1;
+    n2.v = S_inner{5};
+    assert(!cxl::equal(n1, n2) && cxl::hash_value(n1) != cxl::hash_value(n2));
+    n2.v = 4;
+    assert(!cxl::equal(n1, n2) && cxl::hash_value(n1) != cxl::hash_value(n2));
+    n1.v = 4;
+    assert(cxl::equal(n1, n2) && cxl::hash_value(n1) == cxl::hash_value(n2));
+
+    // Unordered containers don't depend on their iteration order
+    std::unordered_map<int, S_inner> u1, u2;
+    for (int i = 0; i < 64; i++) {
+        u1[i] = S_inner{i};
+        u2[63 - i] = S_inner{63 - i};
+    }
+    assert(cxl::reflection::detail::equal_of(u1, u2));
+    assert(cxl::reflection::detail::hash_of(u1) == cxl::reflection::detail::hash_of(u2));
+    u2[7].m1 = 8;
+    assert(!cxl::reflection::detail::equal_of(u1, u2));
+
+    std::unordered_set<S, std::hash<S>, cxl::reflected_equal_to<S>> set;
+    set.insert(a);
+    set.insert(b);
+    set.insert(S{1, 1.0, "x", {1}});
+    assert(set.size() == 2 && set.count(S{1, 1.0, "x", {1}}) == 1);
+}
+
+void test_patch()
+{
+    S a{420, 4.2, "hello", {4200}};
+    S b = a;
+    assert(cxl::diff(a, b).empty());
+    b.m2 = -1.5;
+    b.m4.m1 = -7;
+    cxl::patch<S> p = cxl::diff(a, b);
+    assert(p.size() == 2 && (p.indices() == std::vector<std::size_t>{1, 3}));
+
+    // Count, then index/value pairs: 1 + (1 + 8) + (1 + 1)
+    std::string bytes = p.encode();
+    assert(bytes.size() == 12);
+    cxl::patch<S> q = cxl::patch<S>::decode(bytes);
+    cxl::apply_patch(a, q);
+    assert(cxl::equal(a, b));
+
+    b.m3 = std::string(300, 'x');
+    cxl::apply_patch(a, cxl::patch<S>::decode(cxl::diff(a, b).encode()));
+    assert(a.m3 == b.m3);
+
+    try {
+        cxl::patch<S>::decode(bytes.data(), bytes.size() - 1);
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    // Out of range and readonly element indices are invalid
+    try {
+        cxl::patch<S>::decode(std::string("\x01\x09\x00", 3));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        cxl::patch<SC>::decode(std::string("\x01\x03\x00", 3));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    // Readonly elements are not compared, getter/setter elements go through the setter
+    SC c1(1, 2.0, 3), c2(5, 4.0, 6);
+    cxl::patch<SC> pc = cxl::diff(c1, c2);
+    assert((pc.indices() == std::vector<std::size_t>{0, 2}));
+    cxl::apply_patch(c1, cxl::patch<SC>::decode(pc.encode()));
+    assert(c1.m1 == 5 && c1.get_m3() == 6 && c1.m2 == 2.0);
+
+    // Reflectable elements are encoded as a whole
+    typedef std::pair<int, S> ps_t;
+    ps_t p1(1, a), p2(1, b);
+    p2.second.m4.m1 = 9;
+    cxl::apply_patch(p1, cxl::patch<ps_t>::decode(cxl::diff(p1, p2).encode()));
+    assert(cxl::equal(p1, p2));
+
+    // An empty type has an empty patch
+    assert(cxl::diff(std::tuple<>(), std::tuple<>()).encode() == std::string(1, '\0'));
+
+    // Vectors, maps and variants
+    J j1{1, "a", {1, 2}, {}, {3}, 4, {5, true}}, j2 = j1;
+    j2.tags = {7, 8, 9};
+    j2.scores["x"] = 0.5;
+    j2.v = std::string("text");
+    cxl::patch<J> pj = cxl::diff(j1, j2);
+    assert((pj.indices() == std::vector<std::size_t>{2, 3, 5}));
+    cxl::apply_patch(j1, cxl::patch<J>::decode(pj.encode()));
+    assert(j1.tags == j2.tags && j1.scores == j2.scores && j1.v == j2.v);
+    try {
+        // Variant index 2 of a 2-alternative variant
+        cxl::patch<J>::decode(std::string("\x01\x05\x02\x00", 4));
+        assert(false);
+    } catch (std::invalid_argument &) {
+    }
+
+    // Containers and variants of reflectable values are compared element by element
+    N n1{1, {{1}, {2}}, {{"a", {3}}}, S_inner{4}}, n2 = n1;
+    assert(cxl::diff(n1, n2).empty());
+    n2.items[1].m1 = 5;
+    n2.named["b"] = S_inner{6};
+    n2.v = S_inner{7};
+    cxl::patch<N> pn = cxl::diff(n1, n2);
+    assert((pn.indices() == std::vector<std::size_t>{1, 2, 3}));
+    cxl::apply_patch(n1, cxl::patch<N>::decode(pn.encode()));
+    assert(cxl::equal(n1, n2) && n1.v.get<S_inner>().m1 == 7);
+}
+
+void test_tracked()
+{
+    cxl::tracked<S> t(S{420, 4.2, "hello", {4200}});
+    assert(!t.dirty());
+    t.set<1>(1.5);
+    std::get<3>(t).m1 = 5;
+    cxl::set("MM3", t, std::string("world"));
+    assert(t.dirty(1) && !t.dirty(0) && t.dirty(2) && t.dirty(3));
+    assert(t->m2 == 1.5 && std::get<3>(static_cast<const cxl::tracked<S> &>(t)).m1 == 5);
+    assert(cxl::get_variant(2, t).get<std::string>() == "world");
+
+    S copy{420, 4.2, "hello", {4200}};
+    cxl::apply_patch(copy, cxl::patch<S>::decode(t.dirty_patch().encode()));
+    assert(cxl::equal(copy, t.value()));
+
+    std::size_t visited = 0;
+    t.for_each_dirty_element([&](const auto &, auto i, auto) { visited |= std::size_t(1) << i; });
+    assert(visited == 0xe);
+
+    t.checkpoint();
+    assert(!t.dirty() && t.dirty_patch().empty());
+    cxl::set(0, t, 7);
+    assert(t.dirty_mask().to_ulong() == 1 && t->m1 == 7);
+
+    // Writes through a getter/setter attribute
+    cxl::tracked<SC> c(SC(1, 2.0, 3));
+    c.set<2>(9);
+    assert(c.dirty(2) && c.get<2>() == 9);
 }
 
 int main()
@@ -485,5 +1798,25 @@ int main()
     test_filebuf();
     test_reflected();
     test_csv();
+    test_read_csv();
+    test_read_csv_parallel();
+    test_json_writer();
+    test_json_parser();
+    test_json_reader();
+    test_xml_writer();
+    test_xml_parser();
+    test_binary();
+    test_binary_tagged();
+    test_msgpack();
+    test_element_descriptors();
+    test_index_of();
+    test_field_handle();
+    test_for_each_element_indexed();
+    test_row_binder();
+    test_flatten();
+    test_map_fields();
+    test_hash();
+    test_patch();
+    test_tracked();
     return 0;
 }
@@ -1,8 +1,13 @@
 #ifndef MAIN_HPP
 #define MAIN_HPP
 
+#include <cstdint>
+#include <map>
 #include <string>
 #include <ostream>
+#include <utility>
+#include <vector>
+#include <cxl/variant.hpp>
 #include <cxl/reflection.hpp>
 
 struct S_inner
@@ -30,6 +35,50 @@ inline std::ostream &operator<<(std::ostream &os, const S &s)
     return os;
 }
 
+// A later revision of S, members are matched to S by key
+struct S_v2
+{
+    std::string m3;
+    long m1;
+    int extra;
+    S_inner m4;
+    std::string m2;
+};
+
+// Flat record for CSV round trips
+struct R
+{
+    int id;
+    std::string name;
+    double score;
+    bool active;
+    unsigned long count;
+};
+
+// Nested values for JSON
+struct J
+{
+    int id;
+    std::string name;
+    std::vector<int> tags;
+    std::map<std::string, double> scores;
+    S_inner inner;
+    cxl::variant<int, std::string> v;
+    std::pair<int, bool> flag;
+};
+
+// Adjacent plain members for the binary format
+struct B
+{
+    std::int32_t a;
+    std::int32_t b;
+    double c;
+    bool flag;
+    std::int16_t d;
+    std::vector<double> values;
+    cxl::variant<int, std::string> v;
+};
+
 struct SC
 {
     int m1;
@@ -58,6 +107,26 @@ private:
     /* clang-format on */
 };
 
+// Containers and variants of reflected values, compared element by element
+struct N
+{
+    int id;
+    std::vector<S_inner> items;
+    std::map<std::string, S_inner> named;
+    cxl::variant<int, S_inner> v;
+    std::vector<cxl::variant<int, std::string>> mixed;
+    std::map<std::string, cxl::variant<int, std::string>> labels;
+};
+
+// Pointer member in a non-standard-layout struct, hashed by value
+struct HP
+{
+    virtual ~HP() = default;
+
+    int *p;
+    int n;
+};
+
 // Metadata out of the struct
 /* clang-format off */
 /* @formatter:off */
@@ -70,6 +139,50 @@ CXL_EXT_BEGIN_REFLECTED(S, 4, CXL_SQL_TABLE("some_table"))
     CXL_REFLECTED_MEMBER_KEY(2, m3, "MM3")
     CXL_REFLECTED_MEMBER(3, m4)
 CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(R, 5)
+    CXL_REFLECTED_MEMBER(0, id)
+    CXL_REFLECTED_MEMBER(1, name, CXL_CSV_FIELD("Name"))
+    CXL_REFLECTED_MEMBER(2, score)
+    CXL_REFLECTED_MEMBER(3, active)
+    CXL_REFLECTED_MEMBER(4, count)
+CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(J, 7, CXL_XML_NODE("record"))
+    CXL_REFLECTED_MEMBER(0, id, CXL_XML_NODE("ident"))
+    CXL_REFLECTED_MEMBER(1, name, CXL_JSON_KEY("full name"), CXL_XML_NODE("full_name"))
+    CXL_REFLECTED_MEMBER(2, tags)
+    CXL_REFLECTED_MEMBER(3, scores)
+    CXL_REFLECTED_MEMBER(4, inner)
+    CXL_REFLECTED_MEMBER(5, v)
+    CXL_REFLECTED_MEMBER(6, flag)
+CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(B, 7)
+    CXL_REFLECTED_MEMBER(0, a)
+    CXL_REFLECTED_MEMBER(1, b)
+    CXL_REFLECTED_MEMBER(2, c)
+    CXL_REFLECTED_MEMBER(3, flag)
+    CXL_REFLECTED_MEMBER(4, d)
+    CXL_REFLECTED_MEMBER(5, values)
+    CXL_REFLECTED_MEMBER(6, v)
+CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(N, 6)
+    CXL_REFLECTED_MEMBER(0, id)
+    CXL_REFLECTED_MEMBER(1, items)
+    CXL_REFLECTED_MEMBER(2, named)
+    CXL_REFLECTED_MEMBER(3, v)
+    CXL_REFLECTED_MEMBER(4, mixed)
+    CXL_REFLECTED_MEMBER(5, labels)
+CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(HP, 2)
+    CXL_REFLECTED_MEMBER(0, p)
+    CXL_REFLECTED_MEMBER(1, n)
+CXL_EXT_END_REFLECTED()
+CXL_EXT_BEGIN_REFLECTED(S_v2, 5)
+    CXL_REFLECTED_MEMBER_KEY(0, m3, "MM3")
+    CXL_REFLECTED_MEMBER(1, m1)
+    CXL_REFLECTED_MEMBER(2, extra)
+    CXL_REFLECTED_MEMBER(3, m4)
+    CXL_REFLECTED_MEMBER(4, m2)
+CXL_EXT_END_REFLECTED()
 /* @formatter:on */
 /* clang-format on */
 